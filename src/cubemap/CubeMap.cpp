@@ -30,13 +30,13 @@
 #include "CubeMap.h"
 
 #include <Corrade/Utility/Resource.h>
+#include <Magnum/Image.h>
 #include <Magnum/Mesh.h>
 #include <Magnum/GL/Buffer.h>
 #include <Magnum/GL/Mesh.h>
 #include <Magnum/GL/CubeMapTexture.h>
 #include <Magnum/GL/Texture.h>
 #include <Magnum/GL/TextureFormat.h>
-#include <Magnum/Math/Functions.h>
 #include <Magnum/MeshTools/FlipNormals.h>
 #include <Magnum/MeshTools/Interleave.h>
 #include <Magnum/MeshTools/CompressIndices.h>
@@ -44,15 +44,17 @@
 #include <Magnum/SceneGraph/Scene.h>
 #include <Magnum/SceneGraph/Camera.h>
 #include <Magnum/Trade/AbstractImporter.h>
-#include <Magnum/Trade/ImageData.h>
 #include <Magnum/Trade/MeshData3D.h>
 
 #include "CubeMapShader.h"
+#include "MemoryTracker.h"
+#include "MipChain.h"
 
 namespace Magnum { namespace Examples {
 
 CubeMap::CubeMap(const std::string& prefix, Object3D* parent, SceneGraph::DrawableGroup3D* group): Object3D(parent), SceneGraph::Drawable3D(*this, group) {
     CubeMapResourceManager& resourceManager = CubeMapResourceManager::instance();
+    Resource<MemoryTracker> memory = resourceManager.get<MemoryTracker>("memory");
 
     /* Cube mesh */
     if(!(_cube = resourceManager.get<GL::Mesh>("cube"))) {
@@ -61,6 +63,7 @@ CubeMap::CubeMap(const std::string& prefix, Object3D* parent, SceneGraph::Drawab
 
         GL::Buffer* buffer = new GL::Buffer;
         buffer->setData(MeshTools::interleave(cubeData.positions(0)), GL::BufferUsage::StaticDraw);
+        memory->set(*buffer, "cube vertices", cubeData.positions(0).size()*sizeof(Vector3));
 
         Containers::Array<char> indexData;
         MeshIndexType indexType;
@@ -69,6 +72,7 @@ CubeMap::CubeMap(const std::string& prefix, Object3D* parent, SceneGraph::Drawab
 
         GL::Buffer* indexBuffer = new GL::Buffer;
         indexBuffer->setData(indexData, GL::BufferUsage::StaticDraw);
+        memory->set(*indexBuffer, "cube indices", indexData.size());
 
         GL::Mesh* mesh = new GL::Mesh;
         mesh->setPrimitive(cubeData.primitive())
@@ -91,35 +95,27 @@ CubeMap::CubeMap(const std::string& prefix, Object3D* parent, SceneGraph::Drawab
 
         Resource<Trade::AbstractImporter> importer = resourceManager.get<Trade::AbstractImporter>("jpeg-importer");
 
-        /* Configure texture storage using size of first image */
-        importer->openFile(prefix + "+x.jpg");
-        Containers::Optional<Trade::ImageData2D> image = importer->image2D(0);
-        CORRADE_INTERNAL_ASSERT(image);
-        Vector2i size = image->size();
-        cubeMap->setStorage(Math::log2(size.min())+1, GL::TextureFormat::RGB8, size)
-            .setSubImage(GL::CubeMapCoordinate::PositiveX, 0, {}, *image);
-
-        importer->openFile(prefix + "-x.jpg");
-        CORRADE_INTERNAL_ASSERT_OUTPUT(image = importer->image2D(0));
-        cubeMap->setSubImage(GL::CubeMapCoordinate::NegativeX, 0, {}, *image);
-
-        importer->openFile(prefix + "+y.jpg");
-        CORRADE_INTERNAL_ASSERT_OUTPUT(image = importer->image2D(0));
-        cubeMap->setSubImage(GL::CubeMapCoordinate::PositiveY, 0, {}, *image);
-
-        importer->openFile(prefix + "-y.jpg");
-        CORRADE_INTERNAL_ASSERT_OUTPUT(image = importer->image2D(0));
-        cubeMap->setSubImage(GL::CubeMapCoordinate::NegativeY, 0, {}, *image);
-
-        importer->openFile(prefix + "+z.jpg");
-        CORRADE_INTERNAL_ASSERT_OUTPUT(image = importer->image2D(0));
-        cubeMap->setSubImage(GL::CubeMapCoordinate::PositiveZ, 0, {}, *image);
-
-        importer->openFile(prefix + "-z.jpg");
-        CORRADE_INTERNAL_ASSERT_OUTPUT(image = importer->image2D(0));
-        cubeMap->setSubImage(GL::CubeMapCoordinate::NegativeZ, 0, {}, *image);
-
-        cubeMap->generateMipmap();
+        /* Load the whole mip chain of each face. The chains are generated on
+           the CPU and cached next to the images, as generateMipmap() is
+           extremely slow on software rasterizers. Storage is configured using
+           size of the first image. */
+        const std::pair<GL::CubeMapCoordinate, const char*> faces[]{
+            {GL::CubeMapCoordinate::PositiveX, "+x.jpg"},
+            {GL::CubeMapCoordinate::NegativeX, "-x.jpg"},
+            {GL::CubeMapCoordinate::PositiveY, "+y.jpg"},
+            {GL::CubeMapCoordinate::NegativeY, "-y.jpg"},
+            {GL::CubeMapCoordinate::PositiveZ, "+z.jpg"},
+            {GL::CubeMapCoordinate::NegativeZ, "-z.jpg"}};
+        for(const std::pair<GL::CubeMapCoordinate, const char*>& face: faces) {
+            const std::vector<Image2D> levels = loadMipChain(*importer, prefix + face.second);
+            CORRADE_INTERNAL_ASSERT(!levels.empty());
+            if(face.first == GL::CubeMapCoordinate::PositiveX)
+                cubeMap->setStorage(levels.size(), GL::TextureFormat::RGB8, levels[0].size());
+            for(std::size_t level = 0; level != levels.size(); ++level)
+                cubeMap->setSubImage(face.first, level, {}, levels[level]);
+            if(face.first == GL::CubeMapCoordinate::PositiveX)
+                memory->set(*cubeMap, "cube map", MemoryTracker::textureSize({levels[0].size(), 6}, levels.size(), 4));
+        }
 
         resourceManager.set(_texture.key(), cubeMap, ResourceDataState::Final, ResourcePolicy::Manual);
     }
@@ -28,6 +28,7 @@
 */
 
 #include <Corrade/PluginManager/Manager.h>
+#include <Corrade/Utility/Directory.h>
 #include <Magnum/GL/AbstractShaderProgram.h>
 #include <Magnum/GL/Buffer.h>
 #include <Magnum/GL/Context.h>
@@ -44,6 +45,7 @@
 #include <Magnum/Trade/AbstractImporter.h>
 
 #include "CubeMap.h"
+#include "MemoryTracker.h"
 #include "Reflector.h"
 #include "Types.h"
 
@@ -85,6 +87,10 @@ CubeMapExample::CubeMapExample(const Arguments& arguments): Platform::Applicatio
     _resourceManager.set<Trade::AbstractImporter>("jpeg-importer",
         importer.release(), ResourceDataState::Final, ResourcePolicy::Manual);
 
+    /* Memory accounting, filled by the objects as they create resources */
+    _resourceManager.set<MemoryTracker>("memory",
+        new MemoryTracker, ResourceDataState::Final, ResourcePolicy::Resident);
+
     /* Add objects to scene */
     (new CubeMap(arguments.argc == 2 ? arguments.argv[1] : "", &_scene, &_drawables))
         ->scale(Vector3(20.0f));
@@ -128,6 +134,14 @@ void CubeMapExample::keyPressEvent(KeyEvent& event) {
             .rotateY(event.key() == KeyEvent::Key::Left ? Deg(10.0f) : Deg(-10.0f))
             .translate(Vector3::yAxis(translationY));
 
+    /* Print the largest resources and save a JSON report */
+    } else if(event.key() == KeyEvent::Key::M) {
+        Resource<MemoryTracker> memory = _resourceManager.get<MemoryTracker>("memory");
+        memory->print();
+        if(Utility::Directory::writeString("memory.json", memory->json(50)))
+            Debug{} << "Saved memory report to memory.json";
+        return;
+
     } else return;
 
     redraw();
@@ -0,0 +1,157 @@
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "Downsample.h"
+
+#include <cstring>
+#include <Magnum/Math/Functions.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MAGNUM_EXAMPLES_DOWNSAMPLE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace Magnum { namespace Examples {
+
+namespace {
+
+std::size_t rowSize(const Int width, const UnsignedInt pixelSize) {
+    return (width*pixelSize + 3)/4*4;
+}
+
+/* Destination pixels [begin, end) of a row from a pair of source rows */
+template<UnsignedInt pixelSize> void downsampleScalar(const UnsignedByte* const row0, const UnsignedByte* const row1, UnsignedByte* const out, const Int begin, const Int end) {
+    for(Int x = begin; x < end; ++x) {
+        const UnsignedByte* const a = row0 + 2*x*pixelSize;
+        const UnsignedByte* const b = row1 + 2*x*pixelSize;
+        for(UnsignedInt c = 0; c != pixelSize; ++c)
+            out[x*pixelSize + c] = (a[c] + a[pixelSize + c] + b[c] + b[pixelSize + c] + 2) >> 2;
+    }
+}
+
+#ifdef MAGNUM_EXAMPLES_DOWNSAMPLE_SSE2
+/* Sums of four 8-bit values fit into 16 bits, so each step widens the
+   source rows to 16-bit lanes, adds them vertically, then adds horizontal
+   neighbors and narrows back. Returns count of destination pixels done. */
+Int downsampleSse2Rgba(const UnsignedByte* const row0, const UnsignedByte* const row1, UnsignedByte* const out, const Int pairCount) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i two = _mm_set1_epi16(2);
+    Int x = 0;
+    for(; x + 4 <= pairCount; x += 4) {
+        const __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 8*x));
+        const __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 8*x + 16));
+        const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 8*x));
+        const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 8*x + 16));
+
+        /* Two source pixels in each */
+        const __m128i s0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+        const __m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+        const __m128i s2 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+        const __m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+
+        /* Two destination pixels in each */
+        const __m128i d0 = _mm_add_epi16(_mm_unpacklo_epi64(s0, s1), _mm_unpackhi_epi64(s0, s1));
+        const __m128i d1 = _mm_add_epi16(_mm_unpacklo_epi64(s2, s3), _mm_unpackhi_epi64(s2, s3));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4*x), _mm_packus_epi16(
+            _mm_srli_epi16(_mm_add_epi16(d0, two), 2),
+            _mm_srli_epi16(_mm_add_epi16(d1, two), 2)));
+    }
+    return x;
+}
+
+/* Sum of the two source pixels of destination pixel x in the three lowest
+   lanes. Reads eight bytes, two past the pixel pair. */
+inline __m128i pairSumRgb(const UnsignedByte* const row0, const UnsignedByte* const row1, const Int x) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i s = _mm_add_epi16(
+        _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(row0 + 6*x)), zero),
+        _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(row1 + 6*x)), zero));
+    return _mm_add_epi16(s, _mm_srli_si128(s, 6));
+}
+
+Int downsampleSse2Rgb(const UnsignedByte* const row0, const UnsignedByte* const row1, UnsignedByte* const out, const Int pairCount) {
+    const __m128i two = _mm_set1_epi16(2);
+    Int x = 0;
+    /* The loads read two bytes past the last pair and the stores write one
+       byte past the last pixel, so leave the last pair to the scalar loop */
+    for(; x + 5 <= pairCount; x += 4) {
+        const __m128i d0 = _mm_unpacklo_epi64(pairSumRgb(row0, row1, x), pairSumRgb(row0, row1, x + 1));
+        const __m128i d1 = _mm_unpacklo_epi64(pairSumRgb(row0, row1, x + 2), pairSumRgb(row0, row1, x + 3));
+
+        /* Four pixels with a padding byte each. Each store overwrites the
+           padding of the previous one. */
+        __m128i packed = _mm_packus_epi16(
+            _mm_srli_epi16(_mm_add_epi16(d0, two), 2),
+            _mm_srli_epi16(_mm_add_epi16(d1, two), 2));
+        for(Int i = 0; i != 4; ++i) {
+            const Int pixel = _mm_cvtsi128_si32(packed);
+            std::memcpy(out + 3*(x + i), &pixel, 4);
+            packed = _mm_srli_si128(packed, 4);
+        }
+    }
+    return x;
+}
+#endif
+
+}
+
+void downsample(const char* const src, const Vector2i& srcSize, char* const dst, const Vector2i& dstSize, const UnsignedInt pixelSize, const Int yBegin, const Int yEnd) {
+    const std::size_t srcStride = rowSize(srcSize.x(), pixelSize);
+    const std::size_t dstStride = rowSize(dstSize.x(), pixelSize);
+    const Int pairCount = srcSize.x()/2;
+    for(Int y = yBegin; y != yEnd; ++y) {
+        const auto* const row0 = reinterpret_cast<const UnsignedByte*>(src + Math::min(2*y, srcSize.y() - 1)*srcStride);
+        const auto* const row1 = reinterpret_cast<const UnsignedByte*>(src + Math::min(2*y + 1, srcSize.y() - 1)*srcStride);
+        auto* const out = reinterpret_cast<UnsignedByte*>(dst + y*dstStride);
+
+        Int x = 0;
+        if(pixelSize == 3) {
+            #ifdef MAGNUM_EXAMPLES_DOWNSAMPLE_SSE2
+            x = downsampleSse2Rgb(row0, row1, out, pairCount);
+            #endif
+            downsampleScalar<3>(row0, row1, out, x, pairCount);
+        } else {
+            #ifdef MAGNUM_EXAMPLES_DOWNSAMPLE_SSE2
+            x = downsampleSse2Rgba(row0, row1, out, pairCount);
+            #endif
+            downsampleScalar<4>(row0, row1, out, x, pairCount);
+        }
+
+        /* A source one pixel wide has no pairs, its only column is averaged
+           just vertically */
+        if(pairCount != dstSize.x()) {
+            const std::size_t last = (srcSize.x() - 1)*pixelSize;
+            for(UnsignedInt c = 0; c != pixelSize; ++c)
+                out[pairCount*pixelSize + c] = (row0[last + c] + row1[last + c] + 1) >> 1;
+        }
+    }
+}
+
+}}
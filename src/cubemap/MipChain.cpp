@@ -0,0 +1,200 @@
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "MipChain.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <utility>
+#include <sys/stat.h>
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Utility/Directory.h>
+#ifdef CORRADE_TARGET_WINDOWS
+#include <Corrade/Utility/Unicode.h>
+#endif
+#include <Magnum/ImageView.h>
+#include <Magnum/PixelFormat.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Trade/AbstractImporter.h>
+#include <Magnum/Trade/ImageData.h>
+
+#include "Downsample.h"
+
+namespace Magnum { namespace Examples {
+
+namespace {
+
+/* Header of the cache file, levels follow tightly packed */
+struct MipChainHeader {
+    char magic[4];
+    UnsignedInt format;
+    UnsignedLong sourceSize;
+    Long sourceModificationTime;
+    Vector2i size;
+    UnsignedInt levelCount;
+};
+
+std::size_t rowSize(const Int width, const UnsignedInt pixelSize, const UnsignedInt alignment = 4) {
+    return (width*pixelSize + alignment - 1)/alignment*alignment;
+}
+
+Vector2i levelSize(const Vector2i& size, const UnsignedInt level) {
+    return Math::max(size >> level, Vector2i{1});
+}
+
+/* Levels smaller than this aren't worth spawning threads for */
+constexpr Int MinRowsPerThread = 32;
+
+void downsampleLevel(const Image2D& src, Image2D& dst) {
+    const UnsignedInt threadCount = Math::min(std::max(std::thread::hardware_concurrency(), 1u),
+        UnsignedInt(Math::max(dst.size().y()/MinRowsPerThread, 1)));
+    auto job = [&](const UnsignedInt thread) {
+        const Int yBegin = dst.size().y()*thread/threadCount;
+        const Int yEnd = dst.size().y()*(thread + 1)/threadCount;
+        downsample(src.data(), src.size(), dst.data(), dst.size(), src.pixelSize(), yBegin, yEnd);
+    };
+
+    std::vector<std::thread> threads;
+    for(UnsignedInt i = 1; i < threadCount; ++i)
+        threads.emplace_back(job, i);
+    job(0);
+    for(std::thread& thread: threads) thread.join();
+}
+
+/* Size and modification time of the source file, so a file edited in place
+   without changing its size doesn't get a stale chain. Unlike hashing, this
+   doesn't need to read the file. Both zero if the file doesn't exist. */
+std::pair<UnsignedLong, Long> fileStamp(const std::string& filename) {
+    #ifdef CORRADE_TARGET_WINDOWS
+    struct _stat64 info;
+    if(_wstat64(Utility::Unicode::widen(filename).data(), &info) != 0) return {};
+    #else
+    struct stat info;
+    if(stat(filename.data(), &info) != 0) return {};
+    #endif
+    return {UnsignedLong(info.st_size), Long(info.st_mtime)};
+}
+
+}
+
+std::vector<Image2D> generateMipChain(const ImageView2D& image) {
+    CORRADE_INTERNAL_ASSERT(image.format() == PixelFormat::RGB8Unorm || image.format() == PixelFormat::RGBA8Unorm);
+    const UnsignedInt pixelSize = image.pixelSize();
+
+    /* Copy the base level, normalizing the row alignment */
+    std::vector<Image2D> levels;
+    {
+        const std::size_t srcStride = rowSize(image.size().x(), pixelSize, image.storage().alignment());
+        const std::size_t dstStride = rowSize(image.size().x(), pixelSize);
+        Containers::Array<char> data{Containers::ValueInit, dstStride*image.size().y()};
+        for(Int y = 0; y != image.size().y(); ++y)
+            std::memcpy(data + y*dstStride, image.data() + y*srcStride, image.size().x()*pixelSize);
+        levels.emplace_back(image.format(), image.size(), std::move(data));
+    }
+
+    /* Generate the rest of the chain, down to 1x1 */
+    while(levels.back().size().max() > 1) {
+        const Vector2i size = Math::max(levels.back().size()/2, Vector2i{1});
+        levels.emplace_back(image.format(), size, Containers::Array<char>{Containers::NoInit, rowSize(size.x(), pixelSize)*size.y()});
+        downsampleLevel(levels[levels.size() - 2], levels.back());
+    }
+
+    return levels;
+}
+
+std::vector<Image2D> loadMipChain(Trade::AbstractImporter& importer, const std::string& filename) {
+    const std::string cacheFile = filename + ".mips";
+    const std::pair<UnsignedLong, Long> sourceStamp = fileStamp(filename);
+
+    /* Use the cached chain if it's there and up-to-date */
+    std::vector<Image2D> levels;
+    if(Utility::Directory::exists(cacheFile)) {
+        const Containers::Array<char> data = Utility::Directory::read(cacheFile);
+        MipChainHeader header{};
+        if(data.size() >= sizeof(MipChainHeader))
+            std::memcpy(&header, data, sizeof(MipChainHeader));
+        if(std::memcmp(header.magic, "MIPS", 4) == 0 && header.sourceSize == sourceStamp.first && header.sourceModificationTime == sourceStamp.second && header.levelCount && (PixelFormat(header.format) == PixelFormat::RGB8Unorm || PixelFormat(header.format) == PixelFormat::RGBA8Unorm)) {
+            const PixelFormat format = PixelFormat(header.format);
+            const UnsignedInt pixelSize = format == PixelFormat::RGB8Unorm ? 3 : 4;
+            std::size_t offset = sizeof(MipChainHeader);
+            for(UnsignedInt i = 0; i != header.levelCount; ++i) {
+                const Vector2i size = levelSize(header.size, i);
+                const std::size_t dataSize = rowSize(size.x(), pixelSize)*size.y();
+                if(offset + dataSize > data.size()) break;
+
+                Containers::Array<char> levelData{Containers::NoInit, dataSize};
+                std::memcpy(levelData, data + offset, dataSize);
+                levels.emplace_back(format, size, std::move(levelData));
+                offset += dataSize;
+            }
+
+            if(levels.size() == header.levelCount && levels.back().size().max() == 1)
+                return levels;
+        }
+
+        Warning{} << "Ignoring stale mip chain" << cacheFile;
+        levels.clear();
+    }
+
+    /* Otherwise import the image and generate the chain */
+    if(!importer.openFile(filename)) return {};
+    Containers::Optional<Trade::ImageData2D> image = importer.image2D(0);
+    if(!image || image->isCompressed() || (image->format() != PixelFormat::RGB8Unorm && image->format() != PixelFormat::RGBA8Unorm)) {
+        Error{} << "Cannot import a RGB or RGBA image from" << filename;
+        return {};
+    }
+    levels = generateMipChain(*image);
+
+    /* Save it for the next time. Failing to do so is not fatal, the
+       directory might be read-only. */
+    MipChainHeader header{};
+    std::memcpy(header.magic, "MIPS", 4);
+    header.format = UnsignedInt(image->format());
+    header.sourceSize = sourceStamp.first;
+    header.sourceModificationTime = sourceStamp.second;
+    header.size = image->size();
+    header.levelCount = levels.size();
+    std::size_t dataSize = sizeof(MipChainHeader);
+    for(const Image2D& level: levels) dataSize += level.data().size();
+    Containers::Array<char> data{Containers::NoInit, dataSize};
+    std::memcpy(data, &header, sizeof(MipChainHeader));
+    std::size_t offset = sizeof(MipChainHeader);
+    for(const Image2D& level: levels) {
+        std::memcpy(data + offset, level.data(), level.data().size());
+        offset += level.data().size();
+    }
+    if(Utility::Directory::write(cacheFile, data))
+        Debug{} << "Saved mip chain to" << cacheFile;
+
+    return levels;
+}
+
+}}
@@ -0,0 +1,63 @@
+#ifndef Magnum_Examples_MipChain_h
+#define Magnum_Examples_MipChain_h
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <string>
+#include <vector>
+#include <Magnum/Image.h>
+#include <Magnum/Trade/Trade.h>
+
+namespace Magnum { namespace Examples {
+
+/**
+@brief Generate a full mip chain on the CPU
+
+Expects an 8-bit-per-channel RGB or RGBA image. Returns all levels down to
+1x1, including a copy of the base level, with four-byte row alignment. Each
+level is box-filtered from the previous one using @ref downsample(), with
+rows split across all CPU cores. This is a lot faster than
+@ref GL::Texture::generateMipmap() on software rasterizers.
+*/
+std::vector<Image2D> generateMipChain(const ImageView2D& image);
+
+/**
+@brief Load a mip chain of an image file
+
+If there's a `<filename>.mips` file next to @p filename generated from a file
+with the same size and modification time, the whole chain is loaded from it
+without decoding the image at all. Otherwise the image is imported using @p importer, the chain
+generated with @ref generateMipChain() and saved to `<filename>.mips` for
+the next time. Returns an empty vector if the image can't be imported.
+*/
+std::vector<Image2D> loadMipChain(Trade::AbstractImporter& importer, const std::string& filename);
+
+}}
+
+#endif
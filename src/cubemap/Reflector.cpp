@@ -31,6 +31,7 @@
 
 #include <Corrade/Containers/Array.h>
 #include <Corrade/Utility/Resource.h>
+#include <Magnum/Image.h>
 #include <Magnum/Mesh.h>
 #include <Magnum/GL/Buffer.h>
 #include <Magnum/GL/CubeMapTexture.h>
@@ -45,12 +46,15 @@
 #include <Magnum/Trade/ImageData.h>
 #include <Magnum/Trade/MeshData3D.h>
 
+#include "MemoryTracker.h"
+#include "MipChain.h"
 #include "ReflectorShader.h"
 
 namespace Magnum { namespace Examples {
 
 Reflector::Reflector(Object3D* parent, SceneGraph::DrawableGroup3D* group): Object3D(parent), SceneGraph::Drawable3D(*this, group) {
     CubeMapResourceManager& resourceManager = CubeMapResourceManager::instance();
+    Resource<MemoryTracker> memory = resourceManager.get<MemoryTracker>("memory");
 
     /* Sphere mesh */
     if(!(_sphere = resourceManager.get<GL::Mesh>("sphere"))) {
@@ -58,6 +62,7 @@ Reflector::Reflector(Object3D* parent, SceneGraph::DrawableGroup3D* group): Obje
 
         GL::Buffer* buffer = new GL::Buffer;
         buffer->setData(MeshTools::interleave(sphereData.positions(0), sphereData.textureCoords2D(0)), GL::BufferUsage::StaticDraw);
+        memory->set(*buffer, "sphere vertices", sphereData.positions(0).size()*(sizeof(Vector3) + sizeof(Vector2)));
 
         Containers::Array<char> indexData;
         MeshIndexType indexType;
@@ -66,6 +71,7 @@ Reflector::Reflector(Object3D* parent, SceneGraph::DrawableGroup3D* group): Obje
 
         GL::Buffer* indexBuffer = new GL::Buffer;
         indexBuffer->setData(indexData, GL::BufferUsage::StaticDraw);
+        memory->set(*indexBuffer, "sphere indices", indexData.size());
 
         GL::Mesh* mesh = new GL::Mesh;
         mesh->setPrimitive(sphereData.primitive())
@@ -86,13 +92,18 @@ Reflector::Reflector(Object3D* parent, SceneGraph::DrawableGroup3D* group): Obje
 
         Containers::Optional<Trade::ImageData2D> image = importer->image2D(0);
         CORRADE_INTERNAL_ASSERT(image);
+
+        /* Generate the mip chain on the CPU, generateMipmap() is extremely
+           slow on software rasterizers */
+        const std::vector<Image2D> levels = generateMipChain(*image);
         auto texture = new GL::Texture2D;
         texture->setWrapping(GL::SamplerWrapping::ClampToEdge)
             .setMagnificationFilter(GL::SamplerFilter::Linear)
             .setMinificationFilter(GL::SamplerFilter::Linear, GL::SamplerMipmap::Linear)
-            .setStorage(Math::log2(image->size().min())+1, GL::TextureFormat::RGB8, image->size())
-            .setSubImage(0, {}, *image)
-            .generateMipmap();
+            .setStorage(levels.size(), GL::TextureFormat::RGB8, image->size());
+        for(std::size_t level = 0; level != levels.size(); ++level)
+            texture->setSubImage(level, {}, levels[level]);
+        memory->set(*texture, "tarnish texture", MemoryTracker::textureSize({image->size(), 1}, levels.size(), 4));
 
         resourceManager.set<GL::Texture2D>(_tarnishTexture.key(), texture, ResourceDataState::Final, ResourcePolicy::Resident);
     }
@@ -36,8 +36,10 @@
 #include <Magnum/GL/Texture.h>
 #include <Magnum/Trade/AbstractImporter.h>
 
+#include "MemoryTracker.h"
+
 namespace Magnum {
 
-template class ResourceManager<GL::Buffer, GL::Mesh, Trade::AbstractImporter, GL::Texture2D, GL::CubeMapTexture, GL::AbstractShaderProgram>;
+template class ResourceManager<GL::Buffer, GL::Mesh, Trade::AbstractImporter, GL::Texture2D, GL::CubeMapTexture, GL::AbstractShaderProgram, Examples::MemoryTracker>;
 
 }
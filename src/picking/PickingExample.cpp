@@ -27,6 +27,7 @@
     CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
+#include <Corrade/Utility/Directory.h>
 #include <Corrade/Utility/Resource.h>
 #include <Magnum/Image.h>
 #include <Magnum/PixelFormat.h>
@@ -56,6 +57,8 @@
 #include <Magnum/SceneGraph/Camera.h>
 #include <Magnum/SceneGraph/Drawable.h>
 
+#include "MemoryTracker.h"
+
 namespace Magnum { namespace Examples {
 
 using namespace Magnum::Math::Literals;
@@ -175,6 +178,7 @@ class PickingExample: public Platform::Application {
         void mousePressEvent(MouseEvent& event) override;
         void mouseMoveEvent(MouseMoveEvent& event) override;
         void mouseReleaseEvent(MouseEvent& event) override;
+        void keyPressEvent(KeyEvent& event) override;
 
         Scene3D _scene;
         Object3D* _cameraObject;
@@ -194,6 +198,8 @@ class PickingExample: public Platform::Application {
         GL::Renderbuffer _color, _objectId, _depth;
 
         Vector2i _previousMousePosition, _mousePressPosition;
+
+        MemoryTracker _memory;
 };
 
 PickingExample::PickingExample(const Arguments& arguments): Platform::Application{arguments, Configuration{}.setTitle("Magnum object picking example")}, _framebuffer{GL::defaultFramebuffer.viewport()} {
@@ -212,6 +218,13 @@ PickingExample::PickingExample(const Arguments& arguments): Platform::Applicatio
                .mapForDraw({{PhongIdShader::ColorOutput, GL::Framebuffer::ColorAttachment{0}},
                             {PhongIdShader::ObjectIdOutput, GL::Framebuffer::ColorAttachment{1}}});
     CORRADE_INTERNAL_ASSERT(_framebuffer.checkStatus(GL::FramebufferTarget::Draw) == GL::Framebuffer::Status::Complete);
+    {
+        /* 24-bit depth is usually padded to four bytes */
+        const std::size_t pixelCount = GL::defaultFramebuffer.viewport().size().product();
+        _memory.set(_color, "color", pixelCount*4);
+        _memory.set(_objectId, "object ID", pixelCount);
+        _memory.set(_depth, "depth", pixelCount*4);
+    }
 
     /* Set up meshes */
     {
@@ -222,6 +235,8 @@ PickingExample::PickingExample(const Arguments& arguments): Platform::Applicatio
             .setPrimitive(data.primitive())
             .addVertexBuffer(_cubeVertices, 0, PhongIdShader::Position{}, PhongIdShader::Normal{})
             .setIndexBuffer(_cubeIndices, 0, MeshIndexType::UnsignedShort);
+        _memory.set(_cubeVertices, "cube vertices", data.positions(0).size()*2*sizeof(Vector3));
+        _memory.set(_cubeIndices, "cube indices", data.indices().size()*sizeof(UnsignedShort));
     } {
         Trade::MeshData3D data = Primitives::uvSphereSolid(16, 32);
         _sphereVertices.setData(MeshTools::interleave(data.positions(0), data.normals(0)), GL::BufferUsage::StaticDraw);
@@ -230,12 +245,15 @@ PickingExample::PickingExample(const Arguments& arguments): Platform::Applicatio
             .setPrimitive(data.primitive())
             .addVertexBuffer(_sphereVertices, 0, PhongIdShader::Position{}, PhongIdShader::Normal{})
             .setIndexBuffer(_sphereIndices, 0, MeshIndexType::UnsignedShort);
+        _memory.set(_sphereVertices, "sphere vertices", data.positions(0).size()*2*sizeof(Vector3));
+        _memory.set(_sphereIndices, "sphere indices", data.indices().size()*sizeof(UnsignedShort));
     } {
         Trade::MeshData3D data = Primitives::planeSolid();
         _planeVertices.setData(MeshTools::interleave(data.positions(0), data.normals(0)), GL::BufferUsage::StaticDraw);
         _plane.setCount(data.positions(0).size())
             .setPrimitive(data.primitive())
             .addVertexBuffer(_planeVertices, 0, PhongIdShader::Position{}, PhongIdShader::Normal{});
+        _memory.set(_planeVertices, "plane vertices", data.positions(0).size()*2*sizeof(Vector3));
     }
 
     /* Set up objects */
@@ -330,6 +348,16 @@ void PickingExample::mouseReleaseEvent(MouseEvent& event) {
     redraw();
 }
 
+void PickingExample::keyPressEvent(KeyEvent& event) {
+    /* Print the largest resources and save a JSON report */
+    if(event.key() != KeyEvent::Key::M) return;
+
+    _memory.print();
+    if(Utility::Directory::writeString("memory.json", _memory.json(50)))
+        Debug{} << "Saved memory report to memory.json";
+    event.setAccepted();
+}
+
 }}
 
 MAGNUM_APPLICATION_MAIN(Magnum::Examples::PickingExample)
@@ -0,0 +1,150 @@
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <tuple>
+#include <vector>
+#include <Corrade/Utility/Arguments.h>
+#include <Magnum/GL/Buffer.h>
+#include <Magnum/GL/Mesh.h>
+#include <Magnum/Math/Matrix4.h>
+#include <Magnum/MeshTools/CompressIndices.h>
+#include <Magnum/Platform/WindowlessEglApplication.h>
+#include <Magnum/Primitives/Cube.h>
+#include <Magnum/SceneGraph/Camera.h>
+#include <Magnum/SceneGraph/Drawable.h>
+#include <Magnum/SceneGraph/MatrixTransformation3D.h>
+#include <Magnum/SceneGraph/Scene.h>
+#include <Magnum/Shaders/Generic.h>
+#include <Magnum/Trade/MeshData3D.h>
+
+#include "AllocationCounter.h"
+#include "ShadowCasterDrawable.h"
+#include "ShadowCasterShader.h"
+#include "ShadowLight.h"
+#include "Types.h"
+
+namespace Magnum { namespace Examples {
+
+using namespace Math::Literals;
+
+/* Renders the shadow maps of a scene with moving casters and a moving camera
+   for a given count of frames and counts heap allocations done by
+   ShadowLight::setTarget() and ShadowLight::render() once the layer and
+   caster count settle. Exits with a non-zero code if there are any. Works
+   also on headless machines with just a software rasterizer. */
+class AllocationTest: public Platform::WindowlessApplication {
+    public:
+        explicit AllocationTest(const Arguments& arguments);
+
+        int exec() override;
+
+    private:
+        Utility::Arguments _args;
+};
+
+AllocationTest::AllocationTest(const Arguments& arguments): Platform::WindowlessApplication{arguments} {
+    _args.addOption("frames", "100").setHelp("frames", "count of frames to render in each configuration")
+        .addOption("casters", "200").setHelp("casters", "count of shadow casters")
+        .setGlobalHelp("Verifies that the shadow pass doesn't allocate in a steady state.")
+        .parse(arguments.argc, arguments.argv);
+}
+
+int AllocationTest::exec() {
+    const Trade::MeshData3D cube = Primitives::cubeSolid();
+    GL::Buffer vertices, indices;
+    vertices.setData(cube.positions(0), GL::BufferUsage::StaticDraw);
+    Containers::Array<char> indexData;
+    MeshIndexType indexType;
+    UnsignedInt indexStart, indexEnd;
+    std::tie(indexData, indexType, indexStart, indexEnd) = MeshTools::compressIndices(cube.indices());
+    indices.setData(indexData, GL::BufferUsage::StaticDraw);
+    GL::Mesh mesh;
+    mesh.setPrimitive(cube.primitive())
+        .setCount(cube.indices().size())
+        .addVertexBuffer(vertices, 0, Shaders::Generic3D::Position{})
+        .setIndexBuffer(indices, 0, indexType, indexStart, indexEnd);
+
+    Scene3D scene;
+    Object3D lightObject{&scene};
+    ShadowLight light{lightObject};
+    Object3D cameraObject{&scene};
+    SceneGraph::Camera3D camera{cameraObject};
+    camera.setProjectionMatrix(Matrix4::perspectiveProjection(35.0_degf, 4.0f/3.0f, 0.5f, 50.0f));
+
+    ShadowCasterShader shader, layeredShader{ShadowCasterShader::Mode::Layered, 3};
+    SceneGraph::DrawableGroup3D casters;
+    std::vector<Object3D*> objects;
+    const UnsignedInt casterCount = _args.value<UnsignedInt>("casters");
+    for(UnsignedInt i = 0; i != casterCount; ++i) {
+        objects.push_back(new Object3D{&scene});
+        objects.back()->setTransformation(Matrix4::translation({
+            Float(i%20)*5.0f - 50.0f, Float(i%3), Float(i/20)*5.0f - 50.0f}));
+        auto caster = new ShadowCasterDrawable{*objects.back(), &casters};
+        caster->setShader(shader);
+        caster->setMesh(mesh, Constants::sqrt3());
+    }
+
+    light.setupShadowmaps(3, {1024, 1024});
+    light.setupSplitDistances(0.5f, 50.0f, 3.0f);
+
+    /* The first frame sizes all per-frame arrays, the second grows the ones
+       that are swapped with the previous frame */
+    constexpr UnsignedInt WarmupFrameCount = 2;
+    const UnsignedInt frameCount = _args.value<UnsignedInt>("frames");
+    bool failed = false;
+    for(const bool layered: {false, true}) for(const bool caching: {false, true}) {
+        light.setLayeredShader(layered ? &layeredShader : nullptr)
+            .setCachingEnabled(caching);
+
+        std::size_t allocations = 0;
+        for(UnsignedInt frame = 0; frame != WarmupFrameCount + frameCount; ++frame) {
+            /* Move the camera forward and one caster up and down, so the
+               layers and the dirty caster checks have something to do */
+            cameraObject.setTransformation(Matrix4::translation({0.0f, 3.0f, -0.05f*frame}));
+            objects.front()->translate(Vector3::yAxis(frame % 2 ? -1.0f : 1.0f));
+
+            const std::size_t allocationsBefore = allocationCount();
+            light.setTarget({3.0f, 2.0f, 3.0f}, Vector3::zAxis(), camera);
+            light.render(casters);
+            if(frame >= WarmupFrameCount)
+                allocations += allocationCount() - allocationsBefore;
+        }
+
+        Debug{} << (layered ? "Layered," : "Per-layer,") << "caching"
+            << (caching ? "on:" : "off:") << allocations << "allocations in"
+            << frameCount << "frames";
+        if(allocations) failed = true;
+    }
+
+    return failed ? 1 : 0;
+}
+
+}}
+
+MAGNUM_WINDOWLESSAPPLICATION_MAIN(Magnum::Examples::AllocationTest)
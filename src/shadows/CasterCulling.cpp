@@ -0,0 +1,112 @@
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "CasterCulling.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MAGNUM_EXAMPLES_CULLING_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace Magnum { namespace Examples {
+
+namespace {
+
+#ifdef MAGNUM_EXAMPLES_CULLING_SSE2
+/* Visibility bytes and their count for each 4-bit mask of visible spheres */
+const UnsignedByte VisibleBytes[16][4]{
+    {0, 0, 0, 0}, {1, 0, 0, 0}, {0, 1, 0, 0}, {1, 1, 0, 0},
+    {0, 0, 1, 0}, {1, 0, 1, 0}, {0, 1, 1, 0}, {1, 1, 1, 0},
+    {0, 0, 0, 1}, {1, 0, 0, 1}, {0, 1, 0, 1}, {1, 1, 0, 1},
+    {0, 0, 1, 1}, {1, 0, 1, 1}, {0, 1, 1, 1}, {1, 1, 1, 1}};
+const UnsignedByte VisibleCounts[16]{0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+#endif
+
+/* A sphere is outside if its centre is farther than its radius behind the
+   plane. The SSE2 path below evaluates the same expression in the same order,
+   so both give the same result. */
+inline bool insidePlane(const Vector4& plane, const Float x, const Float y, const Float z, const Float radius) {
+    return plane.x()*x + plane.y()*y + plane.z()*z + plane.w() >= -radius;
+}
+
+}
+
+std::size_t cullSpheres(const Containers::ArrayView<const Vector4> planes, const CasterSpheres& spheres, const std::size_t begin, const std::size_t end, UnsignedByte* const visible) {
+    const std::size_t count = end - begin;
+    const Float* const x = spheres.x.data() + begin;
+    const Float* const y = spheres.y.data() + begin;
+    const Float* const z = spheres.z.data() + begin;
+    const Float* const radius = spheres.radius.data() + begin;
+
+    std::size_t visibleCount = 0;
+    std::size_t i = 0;
+
+    #ifdef MAGNUM_EXAMPLES_CULLING_SSE2
+    /* Four spheres against all planes at a time. Compilers vectorize the
+       plain loop only at higher optimization levels, GCC for example not at
+       -O2. Exiting early once all four spheres are outside is slower with
+       randomly placed casters, as the branch can't be predicted. */
+    const __m128 zero = _mm_setzero_ps();
+    for(; i + 4 <= count; i += 4) {
+        const __m128 sx = _mm_loadu_ps(x + i);
+        const __m128 sy = _mm_loadu_ps(y + i);
+        const __m128 sz = _mm_loadu_ps(z + i);
+        const __m128 negativeRadius = _mm_sub_ps(zero, _mm_loadu_ps(radius + i));
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for(const Vector4& plane: planes) {
+            const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(_mm_set1_ps(plane.x()), sx),
+                _mm_mul_ps(_mm_set1_ps(plane.y()), sy)),
+                _mm_mul_ps(_mm_set1_ps(plane.z()), sz)),
+                _mm_set1_ps(plane.w()));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+        }
+
+        const Int mask = _mm_movemask_ps(inside);
+        std::memcpy(visible + i, VisibleBytes[mask], 4);
+        visibleCount += VisibleCounts[mask];
+    }
+    #endif
+
+    /* The remainder or everything on other platforms */
+    for(; i != count; ++i) {
+        visible[i] = 1;
+        for(const Vector4& plane: planes) if(!insidePlane(plane, x[i], y[i], z[i], radius[i])) {
+            visible[i] = 0;
+            break;
+        }
+        visibleCount += visible[i];
+    }
+
+    return visibleCount;
+}
+
+}}
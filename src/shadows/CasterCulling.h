@@ -0,0 +1,79 @@
+#ifndef Magnum_Examples_CasterCulling_h
+#define Magnum_Examples_CasterCulling_h
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vector>
+#include <Corrade/Containers/ArrayView.h>
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Vector4.h>
+
+namespace Magnum { namespace Examples {
+
+/**
+@brief Bounding spheres of shadow casters
+
+Centres and radii are stored in separate arrays, so @ref cullSpheres() can
+test several consecutive spheres against a plane at once.
+*/
+struct CasterSpheres {
+    std::vector<Float> x, y, z, radius;
+
+    /** @brief Sphere count */
+    std::size_t size() const { return x.size(); }
+
+    /** @brief Resize all arrays */
+    void resize(std::size_t size) {
+        x.resize(size);
+        y.resize(size);
+        z.resize(size);
+        radius.resize(size);
+    }
+};
+
+/**
+@brief Cull bounding spheres against clip planes
+@param planes       Normalized planes with normals pointing inside
+@param spheres      Spheres to cull
+@param begin        First sphere to cull
+@param end          One after the last sphere to cull
+@param visible      Where to write @cpp 1 @ce for each sphere that isn't
+    entirely outside of any of @p planes and @cpp 0 @ce otherwise,
+    @cpp end - begin @ce items
+@return Count of visible spheres
+
+On x86 four spheres are tested against all planes at once with SSE2, without
+any branches. Other platforms and the remaining spheres use a scalar loop
+giving the same result.
+*/
+std::size_t cullSpheres(Containers::ArrayView<const Vector4> planes, const CasterSpheres& spheres, std::size_t begin, std::size_t end, UnsignedByte* visible);
+
+}}
+
+#endif
@@ -0,0 +1,138 @@
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <chrono>
+#include <random>
+#include <Corrade/Utility/Arguments.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Matrix4.h>
+
+#include "CasterCulling.h"
+
+using namespace Magnum;
+using namespace Magnum::Examples;
+
+namespace {
+
+/* The culling loop ShadowLight used before the spheres were stored in
+   separate arrays, testing one sphere at a time */
+std::size_t cullSpheresReference(const Containers::ArrayView<const Vector4> planes, const std::vector<Vector4>& spheres, UnsignedByte* const visible) {
+    std::size_t visibleCount = 0;
+    for(std::size_t i = 0; i != spheres.size(); ++i) {
+        const Vector4 centre{spheres[i].xyz(), 1.0f};
+        visible[i] = 1;
+        for(const Vector4& plane: planes) {
+            if(Math::dot(plane, centre) < -spheres[i].w()) {
+                visible[i] = 0;
+                break;
+            }
+        }
+        visibleCount += visible[i];
+    }
+    return visibleCount;
+}
+
+template<class F> Double minimumTime(const UnsignedInt repeats, F&& f) {
+    Double minimum = 0.0;
+    for(UnsignedInt i = 0; i != repeats; ++i) {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        f();
+        const Double time = std::chrono::duration<double, std::milli>{std::chrono::steady_clock::now() - start}.count();
+        if(!i || time < minimum) minimum = time;
+    }
+    return minimum;
+}
+
+}
+
+/* Compares the SIMD-friendly caster culling in ShadowLight with the scalar
+   loop it replaced on randomly placed spheres. Both cull against the side and
+   far planes of a rotated box covering about a third of the volume, like a
+   shadow map layer would. No GL context is needed. */
+int main(int argc, char** argv) {
+    Utility::Arguments args;
+    args.addOption("min", "10000").setHelp("min", "smallest caster count")
+        .addOption("max", "1000000").setHelp("max", "largest caster count, each step is ten times the previous")
+        .addOption("repeats", "20").setHelp("repeats", "how many times to cull each count, the fastest run is reported")
+        .setHelp("Benchmarks culling of shadow caster bounding spheres against the planes of a shadow map layer.")
+        .parse(argc, argv);
+
+    const std::size_t minCount = args.value<std::size_t>("min");
+    const std::size_t maxCount = args.value<std::size_t>("max");
+    const UnsignedInt repeats = args.value<UnsignedInt>("repeats");
+    if(!minCount || minCount > maxCount || !repeats) {
+        Error{} << "Invalid caster count range or repeat count";
+        return 1;
+    }
+
+    /* Planes of a box with half-size 60 rotated around two axes */
+    const Matrix4 rotation = Matrix4::rotationY(Deg(30.0f))*Matrix4::rotationX(Deg(20.0f));
+    const Vector4 planes[]{
+        {-rotation.backward(), 60.0f},  /* far */
+        { rotation.right(), 60.0f},     /* left */
+        {-rotation.right(), 60.0f},     /* right */
+        { rotation.up(), 60.0f},        /* bottom */
+        {-rotation.up(), 60.0f}};       /* top */
+
+    std::mt19937 random;
+    std::uniform_real_distribution<Float> position{-100.0f, 100.0f}, radius{0.5f, 2.0f};
+    for(std::size_t count = minCount; count <= maxCount; count *= 10) {
+        CasterSpheres spheres;
+        spheres.resize(count);
+        std::vector<Vector4> sphereVectors(count);
+        for(std::size_t i = 0; i != count; ++i) {
+            sphereVectors[i] = {position(random), position(random), position(random), radius(random)};
+            spheres.x[i] = sphereVectors[i].x();
+            spheres.y[i] = sphereVectors[i].y();
+            spheres.z[i] = sphereVectors[i].z();
+            spheres.radius[i] = sphereVectors[i].w();
+        }
+
+        std::vector<UnsignedByte> visible(count), visibleReference(count);
+        std::size_t visibleCount{}, visibleReferenceCount{};
+        const Double referenceTime = minimumTime(repeats, [&]{
+            visibleReferenceCount = cullSpheresReference(planes, sphereVectors, visibleReference.data());
+        });
+        const Double time = minimumTime(repeats, [&]{
+            visibleCount = cullSpheres(planes, spheres, 0, count, visible.data());
+        });
+
+        /* The compiler may fuse the multiplications and additions to FMA
+           instructions, so spheres exactly touching a plane can differ */
+        if(visible != visibleReference)
+            Warning{} << "Culling results differ for" << count << "casters,"
+                << visibleCount << "vs" << visibleReferenceCount << "visible";
+
+        Debug{} << count << "casters," << visibleCount << "visible:"
+            << referenceTime << "ms scalar," << time << "ms SIMD,"
+            << referenceTime/time << Debug::nospace << "x faster";
+    }
+
+    return 0;
+}
@@ -0,0 +1,125 @@
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "DepthRangeReduction.h"
+
+#include <Magnum/GL/Buffer.h>
+#include <Magnum/GL/PixelFormat.h>
+#include <Magnum/GL/TextureFormat.h>
+
+namespace Magnum { namespace Examples {
+
+DepthRangeReduction::Level::Level(const Vector2i& size): framebuffer{{{}, size}}, size{size} {
+    texture.setStorage(1, GL::TextureFormat::RG32F, size)
+        .setMinificationFilter(GL::SamplerFilter::Nearest)
+        .setMagnificationFilter(GL::SamplerFilter::Nearest);
+    framebuffer.attachTexture(GL::Framebuffer::ColorAttachment{0}, texture, 0);
+}
+
+DepthRangeReduction::Readback::Readback(): image{GL::PixelFormat::RG, GL::PixelType::Float} {}
+
+DepthRangeReduction::DepthRangeReduction(const Vector2i& size): _size{size} {
+    _triangle.setCount(3);
+
+    /* Each level is a quarter of the previous, rounded up, down to a single
+       pixel */
+    Vector2i levelSize = size;
+    do {
+        levelSize = (levelSize + Vector2i{3})/4;
+        _levels.emplace_back(levelSize);
+    } while(levelSize != Vector2i{1});
+}
+
+DepthRangeReduction::~DepthRangeReduction() {
+    for(Readback& readback: _readbacks)
+        if(readback.fence) glDeleteSync(readback.fence);
+}
+
+bool DepthRangeReduction::reduce(GL::Texture2D& depth) {
+    fetch();
+
+    /* Everything in flight, don't add more work */
+    Readback& readback = _readbacks[_nextReadback];
+    if(readback.fence) return false;
+
+    for(std::size_t i = 0; i != _levels.size(); ++i) {
+        _levels[i].framebuffer.bind();
+        if(i == 0) {
+            _depthShader.bindInputTexture(depth);
+            _triangle.draw(_depthShader);
+        } else {
+            _rangeShader.bindInputTexture(_levels[i - 1].texture);
+            _triangle.draw(_rangeShader);
+        }
+    }
+
+    /* Copy the result to a buffer and put a fence after, so fetch() can find
+       out when the copy is done without waiting for it */
+    _levels.back().framebuffer.read({{}, Vector2i{1}}, readback.image, GL::BufferUsage::StreamRead);
+    readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    _nextReadback = (_nextReadback + 1) % ReadbackCount;
+    return true;
+}
+
+bool DepthRangeReduction::isPending() const {
+    /* Readbacks are fetched in order, so if the oldest one isn't in flight,
+       no other is */
+    return _readbacks[_pendingReadback].fence;
+}
+
+void DepthRangeReduction::fetch() {
+    /* Readbacks finish in the order they were issued, so look just at the
+       oldest one */
+    for(;;) {
+        Readback& readback = _readbacks[_pendingReadback];
+        if(!readback.fence) return;
+
+        const GLenum status = glClientWaitSync(readback.fence, 0, 0);
+        if(status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            return;
+
+        glDeleteSync(readback.fence);
+        readback.fence = {};
+        _pendingReadback = (_pendingReadback + 1) % ReadbackCount;
+
+        /* The data are in the buffer already, so this doesn't stall. Map
+           it and copy the two values out instead of allocating a new array
+           for them every frame. */
+        Float data[2];
+        GL::Buffer& buffer = readback.image.buffer();
+        const Float* const mapped = buffer.map<Float>(0, sizeof(data), GL::Buffer::MapFlag::Read);
+        data[0] = mapped[0];
+        data[1] = mapped[1];
+        buffer.unmap();
+        if(data[0] <= data[1]) _range = Vector2{data[0], data[1]};
+        else _range = Containers::NullOpt;
+    }
+}
+
+}}
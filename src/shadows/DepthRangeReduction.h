@@ -0,0 +1,151 @@
+#ifndef Magnum_Examples_DepthRangeReduction_h
+#define Magnum_Examples_DepthRangeReduction_h
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vector>
+#include <Corrade/Containers/Optional.h>
+#include <Magnum/GL/BufferImage.h>
+#include <Magnum/GL/Framebuffer.h>
+#include <Magnum/GL/Mesh.h>
+#include <Magnum/GL/OpenGL.h>
+#include <Magnum/GL/Texture.h>
+#include <Magnum/Math/Vector2.h>
+
+#include "DepthReductionShader.h"
+
+namespace Magnum { namespace Examples {
+
+/**
+@brief Minimum and maximum depth of a depth buffer calculated on the GPU
+
+The depth buffer is reduced by a chain of fragment shader passes, each
+shrinking it four times in each direction, down to a single pixel. The pixel
+is then copied to a buffer with a fence after it. The result is read only
+once the fence is signaled, so the CPU never waits for the GPU and the range
+is usually a frame or two behind.
+*/
+class DepthRangeReduction {
+    public:
+        /** @brief Count of readbacks that can be in flight at once */
+        enum: std::size_t { ReadbackCount = 3 };
+
+        /** @brief Constructor */
+        explicit DepthRangeReduction(const Vector2i& size);
+
+        /** @brief Copying is not allowed */
+        DepthRangeReduction(const DepthRangeReduction&) = delete;
+
+        ~DepthRangeReduction();
+
+        /** @brief Copying is not allowed */
+        DepthRangeReduction& operator=(const DepthRangeReduction&) = delete;
+
+        /** @brief Size of the depth buffer */
+        Vector2i size() const { return _size; }
+
+        /** @brief Count of reduction levels */
+        std::size_t levelCount() const { return _levels.size(); }
+
+        /**
+         * @brief Texture of a reduction level
+         *
+         * Two 32-bit float channels with the minimum and maximum depth, for
+         * memory accounting.
+         */
+        const GL::Texture2D& levelTexture(std::size_t level) const {
+            return _levels[level].texture;
+        }
+
+        /** @brief Size of a reduction level */
+        Vector2i levelSize(std::size_t level) const {
+            return _levels[level].size;
+        }
+
+        /**
+         * @brief Reduce a depth texture
+         *
+         * Queues the reduction of @p depth, which is expected to have
+         * @ref size(), and a readback of the result. Picks up results of
+         * previous reductions that the GPU finished in the meantime. If all
+         * @ref ReadbackCount readbacks are still in flight, the reduction is
+         * skipped and @cpp false @ce is returned.
+         */
+        bool reduce(GL::Texture2D& depth);
+
+        /**
+         * @brief Pick up finished reductions
+         *
+         * Updates @ref range() with results the GPU finished since the last
+         * call, without queueing a new reduction. Doesn't wait for the GPU.
+         */
+        void fetch();
+
+        /** @brief Whether any readback is still in flight */
+        bool isPending() const;
+
+        /**
+         * @brief Latest depth range
+         *
+         * Minimum and maximum window-space depth of everything but the
+         * background from the latest reduction the GPU finished.
+         * @ref Containers::NullOpt if no reduction finished yet or if there
+         * was only the background.
+         */
+        Containers::Optional<Vector2> range() const { return _range; }
+
+    private:
+        struct Level {
+            GL::Texture2D texture;
+            GL::Framebuffer framebuffer;
+            Vector2i size;
+
+            explicit Level(const Vector2i& size);
+        };
+
+        struct Readback {
+            GL::BufferImage2D image;
+            GLsync fence{};
+
+            explicit Readback();
+        };
+
+        Vector2i _size;
+        DepthReductionShader _depthShader{DepthReductionShader::Input::Depth},
+            _rangeShader{DepthReductionShader::Input::Range};
+        GL::Mesh _triangle;
+        std::vector<Level> _levels;
+        Readback _readbacks[ReadbackCount];
+        std::size_t _nextReadback{}, _pendingReadback{};
+        Containers::Optional<Vector2> _range;
+};
+
+}}
+
+#endif
@@ -0,0 +1,54 @@
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/* Each output pixel is the minimum and maximum of a 4x4 block of the input.
+   The first pass reads the depth buffer and skips the background, later
+   passes read the minimum from the red and the maximum from the green
+   channel of the previous pass. A block with only background stays at
+   (1, 0). */
+
+uniform highp sampler2D inputTexture;
+
+out highp vec2 range;
+
+void main() {
+    ivec2 inputSize = textureSize(inputTexture, 0);
+    ivec2 base = ivec2(gl_FragCoord.xy)*4;
+
+    range = vec2(1.0, 0.0);
+    for(int y = 0; y != 4; ++y) for(int x = 0; x != 4; ++x) {
+        vec4 value = texelFetch(inputTexture, min(base + ivec2(x, y), inputSize - ivec2(1)), 0);
+        #ifdef DEPTH_INPUT
+        if(value.r < 1.0)
+            range = vec2(min(range.x, value.r), max(range.y, value.r));
+        #else
+        range = vec2(min(range.x, value.r), max(range.y, value.g));
+        #endif
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef Magnum_Examples_DepthReductionShader_h
+#define Magnum_Examples_DepthReductionShader_h
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Magnum/GL/AbstractShaderProgram.h>
+
+namespace Magnum { namespace Examples {
+
+/**
+@brief Shader reducing a depth buffer to its minimum and maximum
+
+Draws a full-screen triangle without any vertex buffers, each output pixel
+being the minimum and maximum depth of a 4x4 block of the input. The output
+is expected to be a two-channel floating-point texture a quarter of the input
+size, rounded up.
+*/
+class DepthReductionShader: public GL::AbstractShaderProgram {
+    public:
+        /** @brief Input of the shader */
+        enum class Input {
+            /** Depth texture, where the background at depth 1 is skipped */
+            Depth,
+
+            /** Minimum and maximum from the previous reduction pass */
+            Range
+        };
+
+        explicit DepthReductionShader(Input input);
+
+        /** @brief Bind the input texture */
+        DepthReductionShader& bindInputTexture(GL::Texture2D& texture);
+
+    private:
+        enum: Int { InputTextureLayer = 0 };
+};
+
+}}
+
+#endif
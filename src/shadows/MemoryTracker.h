@@ -0,0 +1,142 @@
+#ifndef Magnum_Examples_MemoryTracker_h
+#define Magnum_Examples_MemoryTracker_h
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include <Magnum/Magnum.h>
+#include <Magnum/GL/GL.h>
+
+namespace Magnum { namespace Examples {
+
+/**
+@brief Memory accounting of GPU resources
+
+There's no portable way to query how much memory a GL resource actually
+occupies, so the code creating a resource reports its size here, calculated
+from the format and size it was created with. Drivers may pad or compress the
+data, so the numbers are estimates, but good enough to see which resources
+take the most. Resources are identified by their type and GL ID, reporting a
+resource again replaces the previous size, which is what happens when a
+buffer is reallocated. Large CPU-side allocations can be tracked as well,
+identified by an address.
+*/
+class MemoryTracker {
+    public:
+        /** @brief Resource type */
+        enum class Type: UnsignedInt {
+            Buffer,
+            Texture2D,
+            Texture2DArray,
+            CubeMapTexture,
+            Renderbuffer,
+            CpuData
+        };
+
+        /** @brief Count of resource types */
+        enum: std::size_t { TypeCount = std::size_t(Type::CpuData) + 1 };
+
+        /** @brief Tracked resource */
+        struct Entry {
+            Type type;
+            std::uintptr_t id;
+            std::string name;
+            std::size_t size;
+        };
+
+        /** @brief Resource type name */
+        static const char* typeName(Type type);
+
+        /**
+         * @brief Size of a texture
+         *
+         * Size of @p levelCount levels starting at @p size, each level half
+         * the size of the previous one, with @p pixelSize bytes per pixel.
+         * The Z size is a count of layers or faces and isn't halved. Note
+         * that GPUs usually store RGB8 data padded to four bytes per pixel.
+         */
+        static std::size_t textureSize(const Vector3i& size, UnsignedInt levelCount, UnsignedInt pixelSize);
+
+        /**
+         * @brief Set size of a resource
+         *
+         * If the resource is tracked already, its name and size are
+         * replaced.
+         */
+        void set(Type type, std::uintptr_t id, std::string name, std::size_t size);
+
+        void set(const GL::Buffer& buffer, std::string name, std::size_t size); /**< @overload */
+        void set(const GL::Texture2D& texture, std::string name, std::size_t size); /**< @overload */
+        #ifndef MAGNUM_TARGET_GLES2
+        void set(const GL::Texture2DArray& texture, std::string name, std::size_t size); /**< @overload */
+        #endif
+        void set(const GL::CubeMapTexture& texture, std::string name, std::size_t size); /**< @overload */
+        void set(const GL::Renderbuffer& renderbuffer, std::string name, std::size_t size); /**< @overload */
+
+        /** @brief Stop tracking a resource */
+        void remove(Type type, std::uintptr_t id);
+
+        /** @brief Total size of all tracked resources */
+        std::size_t total() const { return _total; }
+
+        /** @brief Total size of tracked resources of given type */
+        std::size_t total(Type type) const { return _totals[std::size_t(type)]; }
+
+        /** @brief Largest total size so far */
+        std::size_t peak() const { return _peak; }
+
+        /** @brief Count of tracked resources */
+        std::size_t count() const { return _entries.size(); }
+
+        /** @brief Count of tracked resources of given type */
+        std::size_t count(Type type) const { return _counts[std::size_t(type)]; }
+
+        /** @brief At most @p count largest resources, largest first */
+        std::vector<const Entry*> largest(std::size_t count) const;
+
+        /** @brief Print totals and at most @p count largest resources */
+        void print(std::size_t count = 10) const;
+
+        /** @brief Totals and at most @p count largest resources as JSON */
+        std::string json(std::size_t count = 10) const;
+
+    private:
+        std::map<std::pair<Type, std::uintptr_t>, Entry> _entries;
+        std::size_t _totals[TypeCount]{};
+        std::size_t _counts[TypeCount]{};
+        std::size_t _total{}, _peak{};
+};
+
+}}
+
+#endif
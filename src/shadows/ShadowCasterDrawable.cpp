@@ -43,4 +43,10 @@ void ShadowCasterDrawable::draw(const Matrix4& transformationMatrix, SceneGraph:
     _mesh->draw(*_shader);
 }
 
+void ShadowCasterDrawable::drawLayers(ShadowCasterShader& shader, const Matrix4& transformationMatrix, const UnsignedInt layerMask) {
+    shader.setTransformationMatrix(transformationMatrix)
+        .setLayerMask(layerMask);
+    _mesh->draw(shader);
+}
+
 }}
@@ -56,6 +56,15 @@ class ShadowCasterDrawable: public SceneGraph::Drawable3D {
 
         void draw(const Matrix4& transformationMatrix, SceneGraph::Camera3D& shadowCamera) override;
 
+        /**
+         * @brief Draw to multiple layers of a layered framebuffer
+         *
+         * Expects that @p shader is created with
+         * @ref ShadowCasterShader::Mode::Layered and has the layer matrices
+         * set already. The @p transformationMatrix is the model matrix.
+         */
+        void drawLayers(ShadowCasterShader& shader, const Matrix4& transformationMatrix, UnsignedInt layerMask);
+
     private:
         GL::Mesh* _mesh{};
         ShadowCasterShader* _shader{};
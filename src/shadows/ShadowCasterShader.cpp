@@ -30,6 +30,7 @@
 
 #include "ShadowCasterShader.h"
 
+#include <string>
 #include <Corrade/Utility/Resource.h>
 #include <Magnum/GL/Context.h>
 #include <Magnum/GL/Shader.h>
@@ -38,8 +39,10 @@
 
 namespace Magnum { namespace Examples {
 
-ShadowCasterShader::ShadowCasterShader() {
+ShadowCasterShader::ShadowCasterShader(const Mode mode, const UnsignedInt layerCount): _layerCount{mode == Mode::Layered ? layerCount : 1} {
     MAGNUM_ASSERT_GL_VERSION_SUPPORTED(GL::Version::GL330);
+    CORRADE_ASSERT(_layerCount >= 1 && _layerCount <= MaxLayers,
+        "ShadowCasterShader: expected 1 to" << MaxLayers << "layers, got" << layerCount, );
 
     const Utility::Resource rs{"shadow-data"};
 
@@ -49,13 +52,28 @@ ShadowCasterShader::ShadowCasterShader() {
     vert.addSource(rs.get("ShadowCaster.vert"));
     frag.addSource(rs.get("ShadowCaster.frag"));
 
-    CORRADE_INTERNAL_ASSERT_OUTPUT(GL::Shader::compile({vert, frag}));
+    if(mode == Mode::Layered) {
+        GL::Shader geom{GL::Version::GL330, GL::Shader::Type::Geometry};
+        geom.addSource("#define LAYER_COUNT " + std::to_string(_layerCount) + "\n"
+                       "#define MAX_VERTICES " + std::to_string(3*_layerCount) + "\n");
+        geom.addSource(rs.get("ShadowCaster.geom"));
 
-    attachShaders({vert, frag});
+        CORRADE_INTERNAL_ASSERT_OUTPUT(GL::Shader::compile({vert, geom, frag}));
+
+        attachShaders({vert, geom, frag});
+    } else {
+        CORRADE_INTERNAL_ASSERT_OUTPUT(GL::Shader::compile({vert, frag}));
+
+        attachShaders({vert, frag});
+    }
 
     CORRADE_INTERNAL_ASSERT_OUTPUT(link());
 
     _transformationMatrixUniform = uniformLocation("transformationMatrix");
+    if(mode == Mode::Layered) {
+        _layerMatricesUniform = uniformLocation("layerMatrices");
+        _layerMaskUniform = uniformLocation("layerMask");
+    }
 }
 
 ShadowCasterShader& ShadowCasterShader::setTransformationMatrix(const Matrix4& matrix) {
@@ -63,4 +81,15 @@ ShadowCasterShader& ShadowCasterShader::setTransformationMatrix(const Matrix4& m
     return *this;
 }
 
+ShadowCasterShader& ShadowCasterShader::setLayerMatrices(const Containers::ArrayView<const Matrix4> matrices) {
+    CORRADE_INTERNAL_ASSERT(matrices.size() <= _layerCount);
+    setUniform(_layerMatricesUniform, matrices);
+    return *this;
+}
+
+ShadowCasterShader& ShadowCasterShader::setLayerMask(const UnsignedInt mask) {
+    setUniform(_layerMaskUniform, mask);
+    return *this;
+}
+
 }}
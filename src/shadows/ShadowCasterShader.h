@@ -30,13 +30,40 @@
     CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
+#include <Corrade/Containers/ArrayView.h>
 #include <Magnum/GL/AbstractShaderProgram.h>
 
 namespace Magnum { namespace Examples {
 
 class ShadowCasterShader: public GL::AbstractShaderProgram {
     public:
-        explicit ShadowCasterShader();
+        /** @brief Max layer count in the layered mode, given by the mask */
+        enum: UnsignedInt { MaxLayers = 32 };
+
+        /** @brief Shader mode */
+        enum class Mode {
+            /** Draws to a single shadow map layer */
+            SingleLayer,
+
+            /**
+             * Draws to all layers of a layered framebuffer selected with
+             * @ref setLayerMask() using a geometry shader
+             */
+            Layered
+        };
+
+        /**
+         * @brief Constructor
+         *
+         * With @ref Mode::Layered, @p layerCount is the count of layers the
+         * geometry shader is compiled for, at most @ref MaxLayers. The
+         * shader has to be recreated when the layer count changes. Ignored
+         * otherwise.
+         */
+        explicit ShadowCasterShader(Mode mode = Mode::SingleLayer, UnsignedInt layerCount = 1);
+
+        /** @brief Count of layers the shader draws to */
+        UnsignedInt layerCount() const { return _layerCount; }
 
         /**
          * @brief Set transformation matrix
@@ -47,8 +74,28 @@ class ShadowCasterShader: public GL::AbstractShaderProgram {
          */
         ShadowCasterShader& setTransformationMatrix(const Matrix4& matrix);
 
+        /**
+         * @brief Set layer matrices
+         *
+         * Transform from world space to clip coordinates of each layer, at
+         * most @ref layerCount() items. The transformation matrix is then just
+         * the model matrix. Expects @ref Mode::Layered.
+         */
+        ShadowCasterShader& setLayerMatrices(Containers::ArrayView<const Matrix4> matrices);
+
+        /**
+         * @brief Set layer mask
+         *
+         * Bit @cpp i @ce set means the mesh gets drawn to layer @cpp i @ce.
+         * Expects @ref Mode::Layered.
+         */
+        ShadowCasterShader& setLayerMask(UnsignedInt mask);
+
     private:
-        Int _transformationMatrixUniform;
+        UnsignedInt _layerCount;
+        Int _transformationMatrixUniform,
+            _layerMatricesUniform{-1},
+            _layerMaskUniform{-1};
 };
 
 }}
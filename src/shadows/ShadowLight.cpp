@@ -36,20 +36,36 @@
 #include <Magnum/GL/PixelFormat.h>
 #include <Magnum/GL/Renderer.h>
 #include <Magnum/GL/TextureFormat.h>
+#include <Magnum/Math/Functions.h>
 #include <Magnum/SceneGraph/FeatureGroup.h>
 #include <Magnum/SceneGraph/MatrixTransformation3D.h>
 #include <Magnum/SceneGraph/Scene.h>
 
 #include "ShadowCasterDrawable.h"
+#include "ShadowCasterShader.h"
 
 namespace Magnum { namespace Examples {
 
-ShadowLight::ShadowLight(SceneGraph::Object<SceneGraph::MatrixTransformation3D>& parent): SceneGraph::Camera3D{parent}, _object(parent), _shadowTexture{NoCreate} {
+namespace {
+
+/* Casters are culled in chunks of this size so even a few layers keep all
+   threads busy */
+constexpr std::size_t CullChunkSize = 1024;
+
+/* With caching, layers move in steps of at most this fraction of the
+   diameter of their part of the view frustum and are larger by the same
+   amount so the frustum stays covered */
+constexpr Float CachedLayerStep = 0.125f;
+
+}
+
+ShadowLight::ShadowLight(SceneGraph::Object<SceneGraph::MatrixTransformation3D>& parent, const UnsignedInt threadCount): SceneGraph::Camera3D{parent}, _object(parent), _shadowTexture{NoCreate}, _layeredFramebuffer{NoCreate}, _threadPool{threadCount} {
     setAspectRatioPolicy(SceneGraph::AspectRatioPolicy::NotPreserved);
 }
 
 void ShadowLight::setupShadowmaps(Int numShadowLevels, const Vector2i& size) {
     _layers.clear();
+    _shadowMapSize = size;
 
     (_shadowTexture = GL::Texture2DArray{})
         .setImage(0, GL::TextureFormat::DepthComponent, ImageView3D{GL::PixelFormat::DepthComponent, GL::PixelType::Float, {size, numShadowLevels}, nullptr})
@@ -67,6 +83,14 @@ void ShadowLight::setupShadowmaps(Int numShadowLevels, const Vector2i& size) {
             .bind();
         CORRADE_INTERNAL_ASSERT(shadowFramebuffer.checkStatus(GL::FramebufferTarget::Draw) == GL::Framebuffer::Status::Complete);
     }
+
+    /* Framebuffer with all layers for drawing them in a single pass */
+    (_layeredFramebuffer = GL::Framebuffer{{{}, size}})
+        .attachLayeredTexture(GL::Framebuffer::BufferAttachment::Depth, _shadowTexture, 0)
+        .mapForDraw(GL::Framebuffer::DrawAttachment::None)
+        .bind();
+    CORRADE_INTERNAL_ASSERT(_layeredFramebuffer.checkStatus(GL::FramebufferTarget::Draw) == GL::Framebuffer::Status::Complete);
+    _layerMatrices.resize(numShadowLevels);
 }
 
 ShadowLight::ShadowLayerData::ShadowLayerData(const Vector2i& size): shadowFramebuffer{{{}, size}} {}
@@ -74,12 +98,50 @@ ShadowLight::ShadowLayerData::ShadowLayerData(const Vector2i& size): shadowFrame
 void ShadowLight::setTarget(const Vector3& lightDirection, const Vector3& screenDirection, SceneGraph::Camera3D& mainCamera) {
     Matrix4 cameraMatrix = Matrix4::lookAt({}, -lightDirection, screenDirection);
     const Matrix3x3 cameraRotationMatrix = cameraMatrix.rotation();
+
+    /* Only the orientation of the object matters, the layers are drawn with
+       their own camera matrices */
+    _object.setTransformation(cameraMatrix);
     const Matrix3x3 inverseCameraRotationMatrix = cameraRotationMatrix.inverted();
 
     for(std::size_t layerIndex = 0; layerIndex != _layers.size(); ++layerIndex) {
-        std::vector<Vector3> mainCameraFrustumCorners = layerFrustumCorners(mainCamera, Int(layerIndex));
+        const std::array<Vector3, 8> mainCameraFrustumCorners = layerFrustumCorners(mainCamera, Int(layerIndex));
         ShadowLayerData& layer = _layers[layerIndex];
 
+        /* With caching, fit the layer around a bounding sphere of the
+           frustum slice, which has the same size regardless of the camera
+           orientation, and move it only in whole steps */
+        if(_cachingEnabled) {
+            Vector3 centre;
+            for(const Vector3& worldPoint: mainCameraFrustumCorners)
+                centre += worldPoint;
+            centre /= Float(mainCameraFrustumCorners.size());
+            Float radius = 0.0f;
+            for(const Vector3& worldPoint: mainCameraFrustumCorners)
+                radius = Math::max(radius, (worldPoint - centre).length());
+
+            /* The radius is slightly different every time due to rounding,
+               keep the previous size unless it changed noticeably */
+            const Float size = 2.0f*radius*(1.0f + CachedLayerStep);
+            if(Math::abs(size - layer.stableSize) > size*1.0e-3f)
+                layer.stableSize = size;
+
+            /* The step is a whole number of texels, so the texel grid stays
+               at the same place in the world and the shadow edges don't
+               shimmer when the layer moves */
+            const Vector2 texelSize = Vector2{layer.stableSize}/Vector2{_shadowMapSize};
+            const Float step = 2.0f*radius*CachedLayerStep;
+            const Vector3 stepSize{texelSize*Math::max(Math::floor(Vector2{step}/texelSize), Vector2{1.0f}), step};
+            const Vector3 snapped = Math::round((inverseCameraRotationMatrix*centre)/stepSize)*stepSize;
+
+            layer.orthographicSize = Vector2{layer.stableSize};
+            layer.orthographicNear = -0.5f*layer.stableSize;
+            layer.orthographicFar = 0.5f*layer.stableSize;
+            cameraMatrix.translation() = cameraRotationMatrix*snapped;
+            layer.shadowCameraMatrix = cameraMatrix;
+            continue;
+        }
+
         /* Calculate the AABB in shadow-camera space */
         Vector3 min{std::numeric_limits<Float>::max()}, max{std::numeric_limits<Float>::lowest()};
         for(Vector3 worldPoint: mainCameraFrustumCorners) {
@@ -103,68 +165,172 @@ void ShadowLight::setTarget(const Vector3& lightDirection, const Vector3& screen
     }
 }
 
+ShadowLight& ShadowLight::setCachingEnabled(const bool enabled) {
+    _cachingEnabled = enabled;
+    invalidate();
+    return *this;
+}
+
+void ShadowLight::invalidate() {
+    for(ShadowLayerData& d: _layers) d.valid = false;
+}
+
+ShadowLight& ShadowLight::setLayeredShader(ShadowCasterShader* const shader) {
+    CORRADE_ASSERT(!shader || _layers.size() <= shader->layerCount(),
+        "ShadowLight::setLayeredShader(): the shader draws to" << shader->layerCount() << "layers but there's" << _layers.size(), *this);
+    _layeredShader = shader;
+    return *this;
+}
+
 Float ShadowLight::cutZ(const Int layer) const {
     return _layers[layer].cutPlane;
 }
 
 void ShadowLight::setupSplitDistances(const Float zNear, const Float zFar, const Float power) {
+    setupSplitDistances(zNear, zFar, power, zNear, zFar);
+}
+
+void ShadowLight::setupSplitDistances(const Float zNear, const Float zFar, const Float power, const Float rangeNear, const Float rangeFar) {
     /* props http://stackoverflow.com/a/33465663 */
-    for(std::size_t i = 0; i != _layers.size(); ++i) {
-        const Float linearDepth = zNear + std::pow(Float(i + 1)/_layers.size(), power)*(zFar - zNear);
+    const auto windowDepth = [zNear, zFar](const Float linearDepth) {
         const Float nonLinearDepth = (zFar + zNear - 2.0f*zNear*zFar/linearDepth)/(zFar - zNear);
-        _layers[i].cutPlane = (nonLinearDepth + 1.0f)/2.0f;
+        return (nonLinearDepth + 1.0f)/2.0f;
+    };
+
+    _nearCutPlane = windowDepth(rangeNear);
+    for(std::size_t i = 0; i != _layers.size(); ++i) {
+        const Float linearDepth = rangeNear + std::pow(Float(i + 1)/_layers.size(), power)*(rangeFar - rangeNear);
+        _layers[i].cutPlane = windowDepth(linearDepth);
     }
 }
 
+Float ShadowLight::depthDistance(const Float zNear, const Float zFar, const Float depth) {
+    const Float depthSample = 2.0f*depth - 1.0f;
+    return 2.0f*zNear*zFar/(zFar + zNear - depthSample*(zFar - zNear));
+}
+
 Float ShadowLight::cutDistance(const Float zNear, const Float zFar, const Int layer) const {
-    const Float depthSample = 2.0f*_layers[layer].cutPlane - 1.0f;
-    const Float zLinear = 2.0f*zNear*zFar/(zFar + zNear - depthSample*(zFar - zNear));
-    return zLinear;
+    return depthDistance(zNear, zFar, _layers[layer].cutPlane);
 }
 
-std::vector<Vector3> ShadowLight::layerFrustumCorners(SceneGraph::Camera3D& mainCamera, const Int layer) {
-    const Float z0 = layer == 0 ? 0 : _layers[layer - 1].cutPlane;
+std::array<Vector3, 8> ShadowLight::layerFrustumCorners(SceneGraph::Camera3D& mainCamera, const Int layer) {
+    /* The cut planes are in window space, the frustum corners need NDC */
+    const Float z0 = layer == 0 ? _nearCutPlane : _layers[layer - 1].cutPlane;
     const Float z1 = _layers[layer].cutPlane;
-    return cameraFrustumCorners(mainCamera, z0, z1);
+    return cameraFrustumCorners(mainCamera, 2.0f*z0 - 1.0f, 2.0f*z1 - 1.0f);
 }
 
-std::vector<Vector3> ShadowLight::cameraFrustumCorners(SceneGraph::Camera3D& mainCamera, const Float z0, const Float z1) {
+std::array<Vector3, 8> ShadowLight::cameraFrustumCorners(SceneGraph::Camera3D& mainCamera, const Float z0, const Float z1) {
     const Matrix4 imvp = (mainCamera.projectionMatrix()*mainCamera.cameraMatrix()).inverted();
     return frustumCorners(imvp, z0, z1);
 }
 
-std::vector<Vector3> ShadowLight::frustumCorners(const Matrix4& imvp, const Float z0, const Float z1) {
-    return {imvp.transformPoint({-1,-1, z0}),
+std::array<Vector3, 8> ShadowLight::frustumCorners(const Matrix4& imvp, const Float z0, const Float z1) {
+    return {{imvp.transformPoint({-1,-1, z0}),
             imvp.transformPoint({ 1,-1, z0}),
             imvp.transformPoint({-1, 1, z0}),
             imvp.transformPoint({ 1, 1, z0}),
             imvp.transformPoint({-1,-1, z1}),
             imvp.transformPoint({ 1,-1, z1}),
             imvp.transformPoint({-1, 1, z1}),
-            imvp.transformPoint({ 1, 1, z1})};
+            imvp.transformPoint({ 1, 1, z1})}};
+}
+
+std::array<Vector4, 6> ShadowLight::calculateClipPlanes() {
+    return calculateClipPlanes(projectionMatrix());
 }
 
-std::vector<Vector4> ShadowLight::calculateClipPlanes() {
-    const Matrix4 pm = projectionMatrix();
-    std::vector<Vector4> clipPlanes{
+std::array<Vector4, 6> ShadowLight::calculateClipPlanes(const Matrix4& pm) {
+    std::array<Vector4, 6> clipPlanes{{
         {pm[3][0] + pm[2][0], pm[3][1] + pm[2][1], pm[3][2] + pm[2][2], pm[3][3] + pm[2][3]},   /* near */
         {pm[3][0] - pm[2][0], pm[3][1] - pm[2][1], pm[3][2] - pm[2][2], pm[3][3] - pm[2][3]},   /* far */
         {pm[3][0] + pm[0][0], pm[3][1] + pm[0][1], pm[3][2] + pm[0][2], pm[3][3] + pm[0][3]},   /* left */
         {pm[3][0] - pm[0][0], pm[3][1] - pm[0][1], pm[3][2] - pm[0][2], pm[3][3] - pm[0][3]},   /* right */
         {pm[3][0] + pm[1][0], pm[3][1] + pm[1][1], pm[3][2] + pm[1][2], pm[3][3] + pm[1][3]},   /* bottom */
-        {pm[3][0] - pm[1][0], pm[3][1] - pm[1][1], pm[3][2] - pm[1][2], pm[3][3] - pm[1][3]}};  /* top */
+        {pm[3][0] - pm[1][0], pm[3][1] - pm[1][1], pm[3][2] - pm[1][2], pm[3][3] - pm[1][3]}}}; /* top */
     for(Vector4& plane: clipPlanes)
         plane *= plane.xyz().lengthInverted();
     return clipPlanes;
 }
 
 void ShadowLight::render(SceneGraph::DrawableGroup3D& drawables) {
-    /* Compute transformations of all objects in the group relative to the camera */
-    std::vector<std::reference_wrapper<Object3D>> objects;
-    objects.reserve(drawables.size());
-    for(std::size_t i = 0; i != drawables.size(); ++i)
-        objects.push_back(static_cast<Object3D&>(drawables[i].object()));
-    std::vector<ShadowCasterDrawable*> filteredDrawables;
+    /* Keep what the casters were in the previous frame to find out which of
+       them moved */
+    std::swap(_casters, _previousCasters);
+    std::swap(_casterTransformations, _previousCasterTransformations);
+    std::swap(_casterSpheres, _previousCasterSpheres);
+
+    /* Compute world transformations of all objects in the group. Nothing
+       below touches the scene graph until the draws are submitted, so the
+       workers can only read what's gathered here. All arrays keep their
+       capacity, so this doesn't allocate once the caster count settles. */
+    _casters.resize(drawables.size());
+    _casterTransformations.resize(drawables.size());
+    for(std::size_t i = 0; i != drawables.size(); ++i) {
+        _casters[i] = &static_cast<ShadowCasterDrawable&>(drawables[i]);
+        _casterTransformations[i] = drawables[i].object().absoluteTransformationMatrix();
+    }
+
+    /* Bounding sphere centres in world space. If your centre is offset,
+       inject it here. */
+    _casterSpheres.resize(_casters.size());
+    for(std::size_t i = 0; i != _casters.size(); ++i) {
+        const Vector3 centre = _casterTransformations[i].translation();
+        _casterSpheres.x[i] = centre.x();
+        _casterSpheres.y[i] = centre.y();
+        _casterSpheres.z[i] = centre.z();
+        _casterSpheres.radius[i] = _casters[i]->radius();
+    }
+
+    /* Casters that moved since the previous frame. If casters got added or
+       removed, there's no telling where the removed ones were, so redraw
+       everything. */
+    if(_casters.size() != _previousCasters.size()) invalidate();
+    _casterDirty.resize(_casters.size());
+    bool anyCasterDirty = false;
+    for(std::size_t i = 0; i != _casters.size(); ++i) {
+        _casterDirty[i] = _casters.size() != _previousCasters.size() ||
+            _casters[i] != _previousCasters[i] ||
+            _casterTransformations[i] != _previousCasterTransformations[i];
+        anyCasterDirty = anyCasterDirty || _casterDirty[i];
+    }
+
+    /* Clip planes of each layer, transformed to world space so the workers
+       don't need to transform each caster to each layer to cull it. With
+       caching, layers that didn't move and can't contain a moved caster
+       aren't even culled. */
+    _culledLayers.clear();
+    for(std::size_t layer = 0; layer != _layers.size(); ++layer) {
+        ShadowLayerData& d = _layers[layer];
+        d.cameraMatrix = d.shadowCameraMatrix.invertedRigid();
+        d.clipMatrix = Matrix4::orthographicProjection(d.orthographicSize, d.orthographicNear, d.orthographicFar)*d.cameraMatrix;
+        d.clipPlanes = calculateClipPlanes(d.clipMatrix);
+        d.needsRender = !_cachingEnabled || !d.valid || d.clipMatrix != d.renderedClipMatrix;
+        if(d.needsRender || anyCasterDirty) _culledLayers.push_back(UnsignedInt(layer));
+    }
+
+    /* Cull each chunk of casters against each layer on all threads. For
+       layered rendering each job goes through all layers for one chunk, so
+       the layer mask of each caster is written by just one thread. The jobs
+       are indexed by layer, not by culled layer, so their count doesn't
+       change from frame to frame with caching and the draw lists keep their
+       capacity. */
+    const std::size_t chunkCount = (_casters.size() + CullChunkSize - 1)/CullChunkSize;
+    _cullJobs.resize(_layers.size()*chunkCount);
+    if(_layeredShader) {
+        CORRADE_ASSERT(_layers.size() <= _layeredShader->layerCount(),
+            "ShadowLight::render(): the layered shader draws to" << _layeredShader->layerCount() << "layers but there's" << _layers.size(), );
+        _casterLayerMasks.resize(_casters.size());
+        _threadPool.run(chunkCount, [this, chunkCount](UnsignedInt, const std::size_t chunk) {
+            const std::size_t begin = chunk*CullChunkSize;
+            const std::size_t end = Math::min(begin + CullChunkSize, _casters.size());
+            std::fill(_casterLayerMasks.begin() + begin, _casterLayerMasks.begin() + end, 0);
+            for(const UnsignedInt layer: _culledLayers)
+                cullLayerChunk(layer, chunk, chunkCount);
+        });
+    } else _threadPool.run(_culledLayers.size()*chunkCount, [this, chunkCount](UnsignedInt, const std::size_t jobIndex) {
+        cullLayerChunk(_culledLayers[jobIndex/chunkCount], jobIndex%chunkCount, chunkCount);
+    });
 
     /* Projecting world points normalized device coordinates means they range
        -1 -> 1. Use this bias matrix so we go straight from world -> texture
@@ -176,69 +342,98 @@ void ShadowLight::render(SceneGraph::DrawableGroup3D& drawables) {
 
     GL::Renderer::setDepthMask(true);
 
-    for(std::size_t layer = 0; layer != _layers.size(); ++layer) {
+    _renderedLayerCount = 0;
+    UnsignedInt dirtyLayerMask = 0;
+    for(const UnsignedInt layer: _culledLayers) {
         ShadowLayerData& d = _layers[layer];
+        const CullJob* const jobs = _cullJobs.data() + layer*chunkCount;
+
+        /* The near plane extended by all chunks. If the layer didn't move
+           and no moved caster is in it, the cached contents are fine. */
         Float orthographicNear = d.orthographicNear;
-        const Float orthographicFar = d.orthographicFar;
-
-        /* Move this whole object to the right place to render each layer */
-        _object.setTransformation(d.shadowCameraMatrix)
-            .setClean();
-        setProjectionMatrix(Matrix4::orthographicProjection(d.orthographicSize, orthographicNear, orthographicFar));
-
-        const std::vector<Vector4> clipPlanes = calculateClipPlanes();
-        std::vector<Matrix4> transformations = _object.scene()->transformationMatrices(objects, cameraMatrix());
-
-        /* Rebuild the list of objects we will draw by clipping them with the
-           shadow camera's planes */
-        std::size_t transformationsOutIndex = 0;
-        filteredDrawables.clear();
-        for(std::size_t drawableIndex = 0; drawableIndex != drawables.size(); ++drawableIndex) {
-            auto& drawable = static_cast<ShadowCasterDrawable&>(drawables[drawableIndex]);
-            const Matrix4 transform = transformations[drawableIndex];
-
-            /* If your centre is offset, inject it here */
-            const Vector4 localCentre{0.0f, 0.0f, 0.0f, 1.0f};
-            const Vector4 drawableCentre = transform*localCentre;
-
-            /* Start at 1, not 0 to skip out the near plane because we need to
-               include shadow casters traveling the direction the camera is
-               facing. */
-            for(std::size_t clipPlaneIndex = 1; clipPlaneIndex != clipPlanes.size(); ++clipPlaneIndex) {
-                const Float distance = Math::dot(clipPlanes[clipPlaneIndex], drawableCentre);
-
-                /* If the object is on the useless side of any one plane, we can skip it */
-                if(distance < -drawable.radius())
-                    goto next;
-            }
-
-            {
-                /* If this object extends in front of the near plane, extend
-                   the near plane. We negate the z because the negative z is
-                   forward away from the camera, but the near/far planes are
-                   measured forwards. */
-                const Float nearestPoint = -drawableCentre.z() - drawable.radius();
-                orthographicNear = Math::min(orthographicNear, nearestPoint);
-                filteredDrawables.push_back(&drawable);
-                transformations[transformationsOutIndex++] = transform;
-            }
-
-            next:;
+        bool dirty = d.needsRender;
+        for(std::size_t chunk = 0; chunk != chunkCount; ++chunk) {
+            orthographicNear = Math::min(orthographicNear, jobs[chunk].orthographicNear);
+            dirty = dirty || jobs[chunk].dirty;
         }
+        if(!dirty) continue;
 
-        /* Recalculate the projection matrix with new near plane. */
         const Matrix4 shadowCameraProjectionMatrix =
-            Matrix4::orthographicProjection(d.orthographicSize, orthographicNear, orthographicFar);
-        d.shadowMatrix = bias*shadowCameraProjectionMatrix*cameraMatrix();
+            Matrix4::orthographicProjection(d.orthographicSize, orthographicNear, d.orthographicFar);
+        d.shadowMatrix = bias*shadowCameraProjectionMatrix*d.cameraMatrix;
+        d.renderedClipMatrix = d.clipMatrix;
+        d.valid = true;
+        ++_renderedLayerCount;
+
+        d.shadowFramebuffer.clear(GL::FramebufferClear::Depth);
+
+        /* With layered rendering just remember the layer is going to be
+           drawn */
+        if(_layeredShader) {
+            _layerMatrices[layer] = shadowCameraProjectionMatrix*d.cameraMatrix;
+            dirtyLayerMask |= 1u << layer;
+            continue;
+        }
+
         setProjectionMatrix(shadowCameraProjectionMatrix);
+        d.shadowFramebuffer.bind();
+        for(std::size_t chunk = 0; chunk != chunkCount; ++chunk)
+            for(const DrawCommand& draw: jobs[chunk].draws)
+                draw.drawable->draw(draw.transformation, *this);
+    }
 
-        d.shadowFramebuffer.clear(GL::FramebufferClear::Depth)
-            .bind();
-        for(std::size_t i = 0; i != transformationsOutIndex; ++i)
-            filteredDrawables[i]->draw(transformations[i], *this);
+    /* Draw each caster just once to all layers it's in that need a redraw,
+       the geometry shader then emits its triangles to each of them */
+    if(dirtyLayerMask) {
+        _layeredShader->setLayerMatrices(_layerMatrices);
+        _layeredFramebuffer.bind();
+        for(std::size_t i = 0; i != _casters.size(); ++i) {
+            const UnsignedInt layerMask = _casterLayerMasks[i] & dirtyLayerMask;
+            if(layerMask) _casters[i]->drawLayers(*_layeredShader, _casterTransformations[i], layerMask);
+        }
     }
 
     GL::defaultFramebuffer.bind();
 }
 
+void ShadowLight::cullLayerChunk(const UnsignedInt layer, const std::size_t chunk, const std::size_t chunkCount) {
+    const ShadowLayerData& d = _layers[layer];
+    const std::size_t begin = chunk*CullChunkSize;
+    const std::size_t end = Math::min(begin + CullChunkSize, _casters.size());
+    const Vector4 depthRow = d.cameraMatrix.row(2);
+
+    /* Skip the near plane because we need to include shadow casters
+       traveling the direction the camera is facing */
+    const Containers::ArrayView<const Vector4> clipPlanes = Containers::arrayView(d.clipPlanes.data() + 1, d.clipPlanes.size() - 1);
+    UnsignedByte visible[CullChunkSize];
+    cullSpheres(clipPlanes, _casterSpheres, begin, end, visible);
+
+    CullJob& job = _cullJobs[layer*chunkCount + chunk];
+    job.draws.clear();
+    job.orthographicNear = d.orthographicNear;
+    job.dirty = false;
+    for(std::size_t i = begin; i != end; ++i) {
+        /* A moved caster makes the layer dirty if it's in the layer now or
+           was there before, leaving its shadow behind. Layers that get
+           redrawn anyway don't need to check. */
+        if(_casterDirty[i] && !d.needsRender && !job.dirty) {
+            UnsignedByte previouslyVisible;
+            job.dirty = visible[i - begin] ||
+                cullSpheres(clipPlanes, _previousCasterSpheres, i, i + 1, &previouslyVisible);
+        }
+
+        if(!visible[i - begin]) continue;
+
+        /* If this object extends in front of the near plane, extend the near
+           plane. We negate the z because the negative z is forward away from
+           the camera, but the near/far planes are measured forwards. */
+        const Vector4 centre{_casterSpheres.x[i], _casterSpheres.y[i], _casterSpheres.z[i], 1.0f};
+        const Float nearestPoint = -Math::dot(depthRow, centre) - _casterSpheres.radius[i];
+        job.orthographicNear = Math::min(job.orthographicNear, nearestPoint);
+
+        if(_layeredShader) _casterLayerMasks[i] |= 1u << layer;
+        else job.draws.push_back({_casters[i], d.cameraMatrix*_casterTransformations[i]});
+    }
+}
+
 }}
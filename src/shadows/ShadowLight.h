@@ -30,6 +30,7 @@
     CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
+#include <array>
 #include <Magnum/Resource.h>
 #include <Magnum/GL/Framebuffer.h>
 #include <Magnum/GL/TextureArray.h>
@@ -37,10 +38,15 @@
 #include <Magnum/SceneGraph/Drawable.h>
 #include <Magnum/SceneGraph/AbstractFeature.h>
 
+#include "CasterCulling.h"
+#include "ThreadPool.h"
 #include "Types.h"
 
 namespace Magnum { namespace Examples {
 
+class ShadowCasterDrawable;
+class ShadowCasterShader;
+
 /**
 @brief A special camera used to render shadow maps
 
@@ -48,11 +54,17 @@ The object it's attached to should face the direction that the light travels.
 */
 class ShadowLight: public SceneGraph::Camera3D {
     public:
-        static std::vector<Vector3> cameraFrustumCorners(SceneGraph::Camera3D& mainCamera, Float z0 = -1.0f, Float z1 = 1.0f);
+        static std::array<Vector3, 8> cameraFrustumCorners(SceneGraph::Camera3D& mainCamera, Float z0 = -1.0f, Float z1 = 1.0f);
 
-        static std::vector<Vector3> frustumCorners(const Matrix4& imvp, Float z0, Float z1);
+        static std::array<Vector3, 8> frustumCorners(const Matrix4& imvp, Float z0, Float z1);
 
-        explicit ShadowLight(SceneGraph::Object<SceneGraph::MatrixTransformation3D>& parent);
+        /**
+         * @brief Constructor
+         *
+         * Shadow casters are culled against all layers on @p threadCount
+         * threads, zero means "use all cores".
+         */
+        explicit ShadowLight(SceneGraph::Object<SceneGraph::MatrixTransformation3D>& parent, UnsignedInt threadCount = 0);
 
         /**
          * @brief Initialize the shadow map texture array and framebuffers
@@ -69,6 +81,18 @@ class ShadowLight: public SceneGraph::Camera3D {
          */
         void setupSplitDistances(Float cameraNear, Float cameraFar, Float power);
 
+        /**
+         * @brief Set up the split distances for a known depth range
+         *
+         * Like @ref setupSplitDistances(Float, Float, Float), but the power
+         * series covers only distances between @p rangeNear and
+         * @p rangeFar, for example the range of depths visible in the
+         * previous frame, so no shadow map resolution is wasted on empty
+         * space in front of and behind the scene. The range is expected to
+         * be inside the camera near and far distance.
+         */
+        void setupSplitDistances(Float cameraNear, Float cameraFar, Float power, Float rangeNear, Float rangeFar);
+
         /**
          * @brief Computes all the matrices for the shadow map splits
          * @param lightDirection    Direction of travel of the light
@@ -84,15 +108,78 @@ class ShadowLight: public SceneGraph::Camera3D {
          */
         void setTarget(const Vector3& lightDirection, const Vector3& screenDirection, SceneGraph::Camera3D& mainCamera);
 
+        /** @brief Whether layer caching is enabled */
+        bool isCachingEnabled() const { return _cachingEnabled; }
+
+        /**
+         * @brief Enable or disable layer caching
+         *
+         * With caching, @ref setTarget() fits each layer around a bounding
+         * sphere of its part of the view frustum with some margin and moves
+         * it in whole texel steps. Small camera moves then don't change the
+         * layer placement at all. @ref render() redraws a layer only if its
+         * placement changed or if a caster that overlaps it either before
+         * or after a move moved. Orienting the layers along the camera
+         * direction in @ref setTarget() changes their placement with every
+         * camera rotation, so use a constant screen direction for best
+         * results. Changes to how the casters are drawn, such as a different
+         * face culling mode, need @ref invalidate(). Disabled by default.
+         */
+        ShadowLight& setCachingEnabled(bool enabled);
+
+        /** @brief Redraw all layers in the next @ref render() */
+        void invalidate();
+
+        /** @brief Shader for drawing all layers in a single pass */
+        ShadowCasterShader* layeredShader() const { return _layeredShader; }
+
+        /**
+         * @brief Draw all layers in a single pass
+         *
+         * With a shader created with @ref ShadowCasterShader::Mode::Layered,
+         * @ref render() draws to the whole shadow texture at once and each
+         * caster is drawn just once to all layers it overlaps. Expects the
+         * shader to be created for at least @ref layerCount() layers, set a
+         * new one after changing the layer count. Pass
+         * @cpp nullptr @ce to draw each layer separately again, which is the
+         * default.
+         */
+        ShadowLight& setLayeredShader(ShadowCasterShader* shader);
+
+        /** @brief Count of layers drawn by the last @ref render() */
+        std::size_t renderedLayerCount() const { return _renderedLayerCount; }
+
         /**
          * @brief Render a group of shadow-casting drawables to the shadow maps
+         *
+         * All drawables in the group are expected to be
+         * @ref ShadowCasterDrawable instances. They are culled against all
+         * layers in parallel first, the calling thread then only submits the
+         * draws. All per-frame data are kept between calls, so once the
+         * caster and layer count settle this doesn't allocate.
          */
         void render(SceneGraph::DrawableGroup3D& drawables);
 
-        std::vector<Vector3> layerFrustumCorners(SceneGraph::Camera3D& mainCamera, Int layer);
+        std::array<Vector3, 8> layerFrustumCorners(SceneGraph::Camera3D& mainCamera, Int layer);
 
+        /**
+         * @brief Window-space depth where given layer ends
+         *
+         * In range @f$ [0, 1] @f$. Layer @cpp 0 @ce starts at
+         * @ref nearCutZ(), the other layers where the previous one ends.
+         */
         Float cutZ(Int layer) const;
 
+        /** @brief Window-space depth where the first layer starts */
+        Float nearCutZ() const { return _nearCutPlane; }
+
+        /**
+         * @brief Convert window-space depth to a distance from the camera
+         *
+         * Expects a perspective projection with given near and far plane.
+         */
+        static Float depthDistance(Float zNear, Float zFar, Float depth);
+
         Float cutDistance(Float zNear, Float zFar, Int layer) const;
 
         std::size_t layerCount() const { return _layers.size(); }
@@ -101,13 +188,25 @@ class ShadowLight: public SceneGraph::Camera3D {
             return _layers[layer].shadowMatrix;
         }
 
-        std::vector<Vector4> calculateClipPlanes();
+        std::array<Vector4, 6> calculateClipPlanes();
+
+        /**
+         * @brief Clip planes of given transformation and projection matrix
+         *
+         * The planes are in the space the matrix transforms from, in order
+         * near, far, left, right, bottom, top.
+         */
+        static std::array<Vector4, 6> calculateClipPlanes(const Matrix4& transformationProjectionMatrix);
 
         GL::Texture2DArray& shadowTexture() { return _shadowTexture; }
 
     private:
+        void cullLayerChunk(UnsignedInt layer, std::size_t chunk, std::size_t chunkCount);
+
         Object3D& _object;
         GL::Texture2DArray _shadowTexture;
+        GL::Framebuffer _layeredFramebuffer;
+        ShadowCasterShader* _layeredShader{};
 
         struct ShadowLayerData {
             GL::Framebuffer shadowFramebuffer;
@@ -117,10 +216,54 @@ class ShadowLight: public SceneGraph::Camera3D {
             Float orthographicNear, orthographicFar;
             Float cutPlane;
 
+            /* Inverse of shadowCameraMatrix, projection of the initial
+               extents combined with it and world-space clip planes of that,
+               calculated in render() */
+            Matrix4 cameraMatrix;
+            Matrix4 clipMatrix;
+            std::array<Vector4, 6> clipPlanes;
+
+            /* Layer size used with caching. The layer contents are valid if
+               they were rendered with renderedClipMatrix and no caster moved
+               since then. */
+            Float stableSize{};
+            Matrix4 renderedClipMatrix;
+            bool valid{};
+            bool needsRender{};
+
             explicit ShadowLayerData(const Vector2i& size);
         };
 
+        struct DrawCommand {
+            ShadowCasterDrawable* drawable;
+            Matrix4 transformation;
+        };
+
+        /* Casters from one chunk that are visible in one layer and whether
+           any of them moved into or out of it. With layered rendering the
+           draws are empty and visibility goes to _casterLayerMasks
+           instead. */
+        struct CullJob {
+            std::vector<DrawCommand> draws;
+            Float orthographicNear;
+            bool dirty;
+        };
+
         std::vector<ShadowLayerData> _layers;
+        Float _nearCutPlane{};
+        std::vector<Matrix4> _layerMatrices;
+        Vector2i _shadowMapSize;
+        bool _cachingEnabled{};
+        std::size_t _renderedLayerCount{};
+
+        ThreadPool _threadPool;
+        std::vector<ShadowCasterDrawable*> _casters, _previousCasters;
+        std::vector<Matrix4> _casterTransformations, _previousCasterTransformations;
+        CasterSpheres _casterSpheres, _previousCasterSpheres;
+        std::vector<UnsignedByte> _casterDirty;
+        std::vector<UnsignedInt> _casterLayerMasks;
+        std::vector<UnsignedInt> _culledLayers;
+        std::vector<CullJob> _cullJobs;
 };
 
 }}
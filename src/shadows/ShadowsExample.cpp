@@ -28,10 +28,17 @@
     CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Utility/Directory.h>
 #include <Magnum/GL/Buffer.h>
 #include <Magnum/GL/DefaultFramebuffer.h>
+#include <Magnum/GL/Framebuffer.h>
+#include <Magnum/GL/Renderbuffer.h>
+#include <Magnum/GL/RenderbufferFormat.h>
 #include <Magnum/GL/Renderer.h>
 #include <Magnum/GL/Texture.h>
+#include <Magnum/GL/TextureFormat.h>
+#include <Magnum/Math/Functions.h>
 #include <Magnum/MeshTools/Interleave.h>
 #include <Magnum/MeshTools/CompressIndices.h>
 #include <Magnum/Platform/Sdl2Application.h>
@@ -47,6 +54,8 @@
 #include <Magnum/Trade/MeshData3D.h>
 
 #include "DebugLines.h"
+#include "DepthRangeReduction.h"
+#include "MemoryTracker.h"
 #include "ShadowCasterShader.h"
 #include "ShadowReceiverShader.h"
 #include "ShadowLight.h"
@@ -83,6 +92,8 @@ class ShadowsExample: public Platform::Application {
         void renderDebugLines();
         Object3D* createSceneObject(Model& model, bool makeCaster, bool makeReceiver);
         void recompileReceiverShader(std::size_t numLayers);
+        void recompileLayeredCasterShader(std::size_t numLayers);
+        void setupShadowmaps(std::size_t numLayers);
         void setShadowMapSize(const Vector2i& shadowMapSize);
         void setShadowSplitExponent(Float power);
 
@@ -90,10 +101,18 @@ class ShadowsExample: public Platform::Application {
         SceneGraph::DrawableGroup3D _shadowCasterDrawables;
         SceneGraph::DrawableGroup3D _shadowReceiverDrawables;
         ShadowCasterShader _shadowCasterShader;
+        std::unique_ptr<ShadowCasterShader> _layeredShadowCasterShader;
         std::unique_ptr<ShadowReceiverShader> _shadowReceiverShader;
 
         DebugLines _debugLines;
 
+        /* The main view is rendered offscreen so its depth can be reduced
+           for sample distribution shadow maps */
+        GL::Renderbuffer _mainColor;
+        GL::Texture2D _mainDepth;
+        GL::Framebuffer _mainFramebuffer;
+        DepthRangeReduction _depthReduction;
+
         Object3D _shadowLightObject;
         ShadowLight _shadowLight;
         Object3D _mainCameraObject;
@@ -106,6 +125,9 @@ class ShadowsExample: public Platform::Application {
 
         std::vector<Model> _models;
 
+        MemoryTracker _memory;
+        Containers::Array<Matrix4> _shadowMatrices;
+
         Vector3 _mainCameraVelocity;
 
         Float _shadowBias;
@@ -113,6 +135,12 @@ class ShadowsExample: public Platform::Application {
         Vector2i _shadowMapSize;
         Int _shadowMapFaceCullMode;
         bool _shadowStaticAlignment;
+        bool _sampleDistribution{};
+
+        /* Main camera transformation of the last queued depth reduction and
+           the depth range the splits were last fitted to */
+        Matrix4 _reducedCameraTransformation{Math::ZeroInit};
+        Containers::Optional<Vector2> _appliedDepthRange;
 };
 
 ShadowsExample::ShadowsExample(const Arguments& arguments):
@@ -123,13 +151,30 @@ ShadowsExample::ShadowsExample(const Arguments& arguments):
     _mainCamera{_mainCameraObject},
     _debugCameraObject{&_scene},
     _debugCamera{_debugCameraObject},
+    _mainFramebuffer{GL::defaultFramebuffer.viewport()},
+    _depthReduction{GL::defaultFramebuffer.viewport().size()},
     _shadowBias{0.003f},
     _layerSplitExponent{3.0f},
     _shadowMapSize{1024, 1024},
     _shadowMapFaceCullMode{1},
     _shadowStaticAlignment{false}
 {
-    _shadowLight.setupShadowmaps(3, _shadowMapSize);
+    setupShadowmaps(3);
+    recompileLayeredCasterShader(3);
+
+    const Vector2i size = GL::defaultFramebuffer.viewport().size();
+    _mainColor.setStorage(GL::RenderbufferFormat::RGBA8, size);
+    _mainDepth.setStorage(1, GL::TextureFormat::DepthComponent24, size)
+        .setMinificationFilter(GL::SamplerFilter::Nearest)
+        .setMagnificationFilter(GL::SamplerFilter::Nearest);
+    _mainFramebuffer.attachRenderbuffer(GL::Framebuffer::ColorAttachment{0}, _mainColor)
+        .attachTexture(GL::Framebuffer::BufferAttachment::Depth, _mainDepth, 0);
+    _memory.set(_mainColor, "main color", MemoryTracker::textureSize({size, 1}, 1, 4));
+    _memory.set(_mainDepth, "main depth", MemoryTracker::textureSize({size, 1}, 1, 4));
+    for(std::size_t i = 0; i != _depthReduction.levelCount(); ++i)
+        _memory.set(_depthReduction.levelTexture(i), "depth reduction level " + std::to_string(i),
+            MemoryTracker::textureSize({_depthReduction.levelSize(i), 1}, 1, 2*sizeof(Float)));
+
     _shadowReceiverShader.reset(new ShadowReceiverShader(_shadowLight.layerCount()));
     _shadowReceiverShader->setShadowBias(_shadowBias);
 
@@ -194,8 +239,9 @@ void ShadowsExample::addModel(const Trade::MeshData3D& meshData3D) {
     _models.emplace_back();
     Model& model = _models.back();
 
-    model.vertexBuffer.setData(MeshTools::interleave(meshData3D.positions(0), meshData3D.normals(0)),
-        GL::BufferUsage::StaticDraw);
+    const Containers::Array<char> vertexData = MeshTools::interleave(meshData3D.positions(0), meshData3D.normals(0));
+    model.vertexBuffer.setData(vertexData, GL::BufferUsage::StaticDraw);
+    _memory.set(model.vertexBuffer, "model " + std::to_string(_models.size() - 1) + " vertices", vertexData.size());
 
     Float maxMagnitudeSquared = 0.0f;
     for(Vector3 position: meshData3D.positions(0)) {
@@ -212,6 +258,7 @@ void ShadowsExample::addModel(const Trade::MeshData3D& meshData3D) {
     UnsignedInt indexStart, indexEnd;
     std::tie(indexData, indexType, indexStart, indexEnd) = MeshTools::compressIndices(meshData3D.indices());
     model.indexBuffer.setData(indexData, GL::BufferUsage::StaticDraw);
+    _memory.set(model.indexBuffer, "model " + std::to_string(_models.size() - 1) + " indices", indexData.size());
 
     model.mesh.setPrimitive(meshData3D.primitive())
         .setCount(meshData3D.indices().size())
@@ -227,6 +274,23 @@ void ShadowsExample::drawEvent() {
         redraw();
     }
 
+    /* Fit the splits to depths visible in one of the previous frames, with a
+       bit of margin for the camera moving since. The range lags a frame or
+       two behind, so keep redrawing while reductions are in flight or the
+       splits don't match the latest range yet. Once the camera stops, no
+       new reductions are queued and the redrawing stops too. */
+    if(_sampleDistribution) {
+        _depthReduction.fetch();
+        const Containers::Optional<Vector2> range = _depthReduction.range();
+        if(range && (!_appliedDepthRange || *range != *_appliedDepthRange)) {
+            const Float rangeNear = Math::max(ShadowLight::depthDistance(MainCameraNear, MainCameraFar, range->x())*0.9f, MainCameraNear);
+            const Float rangeFar = Math::min(ShadowLight::depthDistance(MainCameraNear, MainCameraFar, range->y())*1.1f, MainCameraFar);
+            _shadowLight.setupSplitDistances(MainCameraNear, MainCameraFar, _layerSplitExponent, rangeNear, rangeFar);
+            _appliedDepthRange = range;
+        }
+        if(_depthReduction.isPending()) redraw();
+    }
+
     const Vector3 screenDirection = _shadowStaticAlignment ? Vector3::zAxis() : _mainCameraObject.transformation()[2].xyz();
     /* You only really need to do this when your camera moves */
     _shadowLight.setTarget({3, 2, 3}, screenDirection, _mainCamera);
@@ -254,21 +318,42 @@ void ShadowsExample::drawEvent() {
             break;
     }
 
+    /* Only the main camera depth is useful for fitting the splits, render
+       offscreen to have it in a texture. Otherwise there's no need for the
+       extra blit. The scene is static, so the depth changes only with the
+       camera. */
+    const bool reduceDepth = _sampleDistribution && _activeCamera == &_mainCamera &&
+        _mainCameraObject.transformationMatrix() != _reducedCameraTransformation;
+    GL::AbstractFramebuffer& framebuffer = reduceDepth ?
+        static_cast<GL::AbstractFramebuffer&>(_mainFramebuffer) : GL::defaultFramebuffer;
     GL::Renderer::setClearColor({0.1f, 0.1f, 0.4f, 1.0f});
-    GL::defaultFramebuffer.clear(GL::FramebufferClear::Color|GL::FramebufferClear::Depth);
+    framebuffer.clear(GL::FramebufferClear::Color|GL::FramebufferClear::Depth)
+        .bind();
 
-    Containers::Array<Matrix4> shadowMatrices{Containers::NoInit, _shadowLight.layerCount()};
     for(std::size_t layerIndex = 0; layerIndex != _shadowLight.layerCount(); ++layerIndex)
-        shadowMatrices[layerIndex] = _shadowLight.layerMatrix(layerIndex);
+        _shadowMatrices[layerIndex] = _shadowLight.layerMatrix(layerIndex);
 
-    _shadowReceiverShader->setShadowmapMatrices(shadowMatrices)
+    _shadowReceiverShader->setShadowmapMatrices(_shadowMatrices)
         .setShadowmapTexture(_shadowLight.shadowTexture())
         .setLightDirection(_shadowLightObject.transformation().backward());
 
     _activeCamera->draw(_shadowReceiverDrawables);
 
+    /* Doesn't wait for the GPU, the result is picked up in one of the next
+       frames */
+    if(reduceDepth) {
+        if(_depthReduction.reduce(_mainDepth))
+            _reducedCameraTransformation = _mainCameraObject.transformationMatrix();
+        _mainFramebuffer.bind();
+        redraw();
+    }
+
     renderDebugLines();
 
+    if(reduceDepth)
+        GL::AbstractFramebuffer::blit(_mainFramebuffer, GL::defaultFramebuffer,
+            _mainFramebuffer.viewport(), GL::FramebufferBlit::Color);
+
     swapBuffers();
 }
 
@@ -290,7 +375,8 @@ void ShadowsExample::renderDebugLines() {
             Color3::fromHsv(hue, 1.0f, 0.5f));
         _debugLines.addFrustum(imvp,
             Color3::fromHsv(hue, 1.0f, 1.0f),
-            layerIndex == 0 ? 0 : _shadowLight.cutZ(layerIndex - 1), _shadowLight.cutZ(layerIndex));
+            2.0f*(layerIndex == 0 ? _shadowLight.nearCutZ() : _shadowLight.cutZ(layerIndex - 1)) - 1.0f,
+            2.0f*_shadowLight.cutZ(layerIndex) - 1.0f);
     }
 
     _debugLines.draw(_activeCamera->projectionMatrix()*_activeCamera->cameraMatrix());
@@ -355,6 +441,7 @@ void ShadowsExample::keyPressEvent(KeyEvent& event) {
 
     } else if(event.key() == KeyEvent::Key::F3) {
         _shadowMapFaceCullMode = (_shadowMapFaceCullMode + 1) % 3;
+        _shadowLight.invalidate();
         Debug() << "Face cull mode:"
             << (_shadowMapFaceCullMode == 0 ? "no cull" : _shadowMapFaceCullMode == 1 ? "cull back" : "cull front");
 
@@ -380,18 +467,22 @@ void ShadowsExample::keyPressEvent(KeyEvent& event) {
     } else if(event.key() == KeyEvent::Key::F9) {
         std::size_t numLayers = _shadowLight.layerCount() - 1;
         if(numLayers >= 1) {
-            _shadowLight.setupShadowmaps(numLayers, _shadowMapSize);
+            setupShadowmaps(numLayers);
             recompileReceiverShader(numLayers);
+            recompileLayeredCasterShader(numLayers);
             _shadowLight.setupSplitDistances(MainCameraNear, MainCameraFar, _layerSplitExponent);
+            _appliedDepthRange = Containers::NullOpt;
             Debug() << "Shadow map size" << _shadowMapSize << "x" << _shadowLight.layerCount() << "layers";
         } else return;
 
     } else if(event.key() == KeyEvent::Key::F10) {
         std::size_t numLayers = _shadowLight.layerCount() + 1;
-        if(numLayers <= 32) {
-            _shadowLight.setupShadowmaps(numLayers, _shadowMapSize);
+        if(numLayers <= ShadowCasterShader::MaxLayers) {
+            setupShadowmaps(numLayers);
             recompileReceiverShader(numLayers);
+            recompileLayeredCasterShader(numLayers);
             _shadowLight.setupSplitDistances(MainCameraNear, MainCameraFar, _layerSplitExponent);
+            _appliedDepthRange = Containers::NullOpt;
             Debug() << "Shadow map size" << _shadowMapSize << "x" << _shadowLight.layerCount() << "layers";
         } else return;
 
@@ -401,6 +492,34 @@ void ShadowsExample::keyPressEvent(KeyEvent& event) {
     } else if(event.key() == KeyEvent::Key::F12) {
         setShadowMapSize(_shadowMapSize*2);
 
+    /* Print the largest resources and save a JSON report */
+    } else if(event.key() == KeyEvent::Key::M) {
+        _memory.print();
+        if(Utility::Directory::writeString("memory.json", _memory.json(50)))
+            Debug{} << "Saved memory report to memory.json";
+
+    } else if(event.key() == KeyEvent::Key::A) {
+        Debug() << "Shadow layers drawn in the last frame:" << _shadowLight.renderedLayerCount() << "of" << _shadowLight.layerCount();
+
+    } else if(event.key() == KeyEvent::Key::L) {
+        _shadowLight.setLayeredShader(_shadowLight.layeredShader() ? nullptr : _layeredShadowCasterShader.get());
+        Debug() << "Shadow layers drawn:"
+            << (_shadowLight.layeredShader() ? "in a single pass" : "one by one");
+
+    } else if(event.key() == KeyEvent::Key::C) {
+        _shadowLight.setCachingEnabled(!_shadowLight.isCachingEnabled());
+        Debug() << "Shadow layer caching:"
+            << (_shadowLight.isCachingEnabled() ? "on" : "off");
+
+    } else if(event.key() == KeyEvent::Key::S) {
+        _sampleDistribution = !_sampleDistribution;
+        if(!_sampleDistribution)
+            _shadowLight.setupSplitDistances(MainCameraNear, MainCameraFar, _layerSplitExponent);
+        _reducedCameraTransformation = Matrix4{Math::ZeroInit};
+        _appliedDepthRange = Containers::NullOpt;
+        Debug() << "Shadow splits:"
+            << (_sampleDistribution ? "fit to the visible depth range" : "fixed");
+
     } else return;
 
     event.setAccepted();
@@ -409,6 +528,8 @@ void ShadowsExample::keyPressEvent(KeyEvent& event) {
 
 void ShadowsExample::setShadowSplitExponent(const Float power) {
     _shadowLight.setupSplitDistances(MainCameraNear, MainCameraFar, power);
+    /* Fit the new splits to the depth range again in the next frame */
+    _appliedDepthRange = Containers::NullOpt;
     std::string buf;
     for(std::size_t layer = 0; layer != _shadowLight.layerCount(); ++layer) {
         if(layer) buf += ", ";
@@ -421,11 +542,20 @@ void ShadowsExample::setShadowSplitExponent(const Float power) {
 void ShadowsExample::setShadowMapSize(const Vector2i& shadowMapSize) {
     if((shadowMapSize >= Vector2i{1}).all() && (shadowMapSize <= GL::Texture2D::maxSize()).all()) {
         _shadowMapSize = shadowMapSize;
-        _shadowLight.setupShadowmaps(_shadowLight.layerCount(), _shadowMapSize);
+        setupShadowmaps(_shadowLight.layerCount());
         Debug() << "Shadow map size" << shadowMapSize << "x" << _shadowLight.layerCount() << "layers";
     }
 }
 
+void ShadowsExample::setupShadowmaps(const std::size_t numLayers) {
+    /* The texture gets recreated, forget the old one */
+    _memory.remove(MemoryTracker::Type::Texture2DArray, _shadowLight.shadowTexture().id());
+    _shadowLight.setupShadowmaps(numLayers, _shadowMapSize);
+    _shadowMatrices = Containers::Array<Matrix4>{Containers::NoInit, numLayers};
+    _memory.set(_shadowLight.shadowTexture(), "shadow map",
+        MemoryTracker::textureSize({_shadowMapSize, Int(numLayers)}, 1, 4));
+}
+
 void ShadowsExample::recompileReceiverShader(const std::size_t numLayers) {
     _shadowReceiverShader.reset(new ShadowReceiverShader(numLayers));
     _shadowReceiverShader->setShadowBias(_shadowBias);
@@ -435,6 +565,13 @@ void ShadowsExample::recompileReceiverShader(const std::size_t numLayers) {
     }
 }
 
+void ShadowsExample::recompileLayeredCasterShader(const std::size_t numLayers) {
+    /* The geometry shader emits vertices for exactly this many layers */
+    const bool layered = _shadowLight.layeredShader();
+    _layeredShadowCasterShader.reset(new ShadowCasterShader{ShadowCasterShader::Mode::Layered, UnsignedInt(numLayers)});
+    if(layered) _shadowLight.setLayeredShader(_layeredShadowCasterShader.get());
+}
+
 void ShadowsExample::keyReleaseEvent(KeyEvent &event) {
     if(event.key() == KeyEvent::Key::Up || event.key() == KeyEvent::Key::Down) {
         _mainCameraVelocity.z() = 0.0f;
@@ -0,0 +1,106 @@
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace Magnum { namespace Examples {
+
+ThreadPool::ThreadPool(UnsignedInt threadCount) {
+    if(!threadCount) threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+    for(UnsignedInt i = 1; i < threadCount; ++i)
+        _threads.emplace_back(&ThreadPool::work, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _exit = true;
+    }
+    _started.notify_all();
+    for(std::thread& thread: _threads) thread.join();
+}
+
+void ThreadPool::runInternal(const std::size_t count, const Function function, void* const job) {
+    /* Not worth waking anybody up */
+    if(_threads.empty() || count < 2) {
+        for(std::size_t i = 0; i != count; ++i) function(job, 0, i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _function = function;
+        _job = job;
+        _count = count;
+        _next = 0;
+        _running = UnsignedInt(_threads.size());
+        ++_generation;
+    }
+    _started.notify_all();
+
+    for(std::size_t i; (i = _next++) < count; )
+        function(job, 0, i);
+
+    /* The job is referenced by the workers until they all check in */
+    std::unique_lock<std::mutex> lock{_mutex};
+    _finished.wait(lock, [this]{ return _running == 0; });
+    _job = nullptr;
+}
+
+void ThreadPool::work(const UnsignedInt thread) {
+    UnsignedLong generation = 0;
+    for(;;) {
+        Function function;
+        void* job;
+        std::size_t count;
+        {
+            std::unique_lock<std::mutex> lock{_mutex};
+            _started.wait(lock, [&]{ return _exit || _generation != generation; });
+            if(_exit) return;
+            generation = _generation;
+            function = _function;
+            job = _job;
+            count = _count;
+        }
+
+        for(std::size_t i; (i = _next++) < count; )
+            function(job, thread, i);
+
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            --_running;
+        }
+        _finished.notify_one();
+    }
+}
+
+}}
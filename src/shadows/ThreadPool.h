@@ -0,0 +1,110 @@
+#ifndef Magnum_Examples_ThreadPool_h
+#define Magnum_Examples_ThreadPool_h
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <Magnum/Magnum.h>
+
+namespace Magnum { namespace Examples {
+
+/**
+@brief Pool of worker threads for jobs executed every frame
+
+Unlike spawning threads for each batch of work, the workers are created just
+once and sleep between calls to @ref run(), so it's cheap enough to be used
+several times per frame.
+*/
+class ThreadPool {
+    public:
+        /**
+         * @brief Constructor
+         *
+         * Zero @p threadCount means "use all cores". The calling thread is
+         * counted as well, so @cpp 1 @ce doesn't spawn any threads.
+         */
+        explicit ThreadPool(UnsignedInt threadCount = 0);
+
+        /** @brief Copying is not allowed */
+        ThreadPool(const ThreadPool&) = delete;
+
+        /** @brief Destructor, waits for the workers to exit */
+        ~ThreadPool();
+
+        /** @brief Copying is not allowed */
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /** @brief Thread count including the calling thread */
+        UnsignedInt threadCount() const { return UnsignedInt(_threads.size()) + 1; }
+
+        /**
+         * @brief Execute a job for each index in given range
+         *
+         * Calls @p job with the thread ID in range
+         * @cpp [0, threadCount()) @ce and an item index in range
+         * @cpp [0, count) @ce. Items are distributed dynamically and the
+         * calling thread, with ID @cpp 0 @ce, processes items as well.
+         * Returns after all items are processed. The job is passed to the
+         * workers by reference, so this doesn't allocate. Not reentrant.
+         */
+        template<class Job> void run(std::size_t count, Job&& job) {
+            typedef typename std::remove_reference<Job>::type Type;
+            runInternal(count, &invoke<Type>, const_cast<void*>(static_cast<const void*>(&job)));
+        }
+
+    private:
+        typedef void(*Function)(void*, UnsignedInt, std::size_t);
+
+        template<class Job> static void invoke(void* const job, const UnsignedInt thread, const std::size_t i) {
+            (*static_cast<Job*>(job))(thread, i);
+        }
+
+        void runInternal(std::size_t count, Function function, void* job);
+        void work(UnsignedInt thread);
+
+        std::vector<std::thread> _threads;
+        std::mutex _mutex;
+        std::condition_variable _started, _finished;
+        Function _function{};
+        void* _job{};
+        std::size_t _count{};
+        std::atomic<std::size_t> _next{0};
+        UnsignedLong _generation{};
+        UnsignedInt _running{};
+        bool _exit{};
+};
+
+}}
+
+#endif
@@ -0,0 +1,205 @@
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "BlockCompression.h"
+
+#include <cstring>
+#include <utility>
+#include <Magnum/Math/Functions.h>
+
+namespace Magnum { namespace Examples {
+
+namespace {
+
+UnsignedShort packRgb565(const UnsignedByte* const color) {
+    return ((color[0]*31 + 127)/255) << 11 |
+           ((color[1]*63 + 127)/255) << 5 |
+            (color[2]*31 + 127)/255;
+}
+
+void unpackRgb565(const UnsignedShort packed, Int* const color) {
+    const Int r = packed >> 11, g = (packed >> 5) & 0x3f, b = packed & 0x1f;
+    color[0] = (r << 3)|(r >> 2);
+    color[1] = (g << 2)|(g >> 4);
+    color[2] = (b << 3)|(b >> 2);
+}
+
+void writeLittleEndian(char* const out, UnsignedLong value, const std::size_t size) {
+    for(std::size_t i = 0; i != size; ++i, value >>= 8)
+        out[i] = char(value & 0xff);
+}
+
+/* Color part of a BC1 / BC3 block from 16 RGBA pixels, always in the
+   four-color mode */
+void compressColorBlock(const UnsignedByte(&pixels)[16][4], char* const out) {
+    /* Principal axis of the colors using a few power iterations on the
+       covariance matrix, starting from the bounding box diagonal */
+    Float mean[3]{};
+    UnsignedByte min[3]{255, 255, 255}, max[3]{};
+    for(const UnsignedByte* const pixel: pixels) for(std::size_t c = 0; c != 3; ++c) {
+        mean[c] += pixel[c];
+        min[c] = Math::min(min[c], pixel[c]);
+        max[c] = Math::max(max[c], pixel[c]);
+    }
+    for(Float& c: mean) c /= 16.0f;
+
+    Float covariance[6]{};
+    for(const UnsignedByte* const pixel: pixels) {
+        const Float r = pixel[0] - mean[0], g = pixel[1] - mean[1], b = pixel[2] - mean[2];
+        covariance[0] += r*r;
+        covariance[1] += r*g;
+        covariance[2] += r*b;
+        covariance[3] += g*g;
+        covariance[4] += g*b;
+        covariance[5] += b*b;
+    }
+
+    Float axis[3]{Float(max[0] - min[0]), Float(max[1] - min[1]), Float(max[2] - min[2])};
+    for(Int i = 0; i != 4; ++i) {
+        const Float r = axis[0]*covariance[0] + axis[1]*covariance[1] + axis[2]*covariance[2];
+        const Float g = axis[0]*covariance[1] + axis[1]*covariance[3] + axis[2]*covariance[4];
+        const Float b = axis[0]*covariance[2] + axis[1]*covariance[4] + axis[2]*covariance[5];
+        const Float length = Math::max(Math::max(Math::abs(r), Math::abs(g)), Math::abs(b));
+        if(length == 0.0f) break;
+        axis[0] = r/length;
+        axis[1] = g/length;
+        axis[2] = b/length;
+    }
+
+    /* Endpoints are the pixels with extreme projections on the axis */
+    std::size_t minPixel = 0, maxPixel = 0;
+    Float minProjection = 0.0f, maxProjection = 0.0f;
+    for(std::size_t i = 0; i != 16; ++i) {
+        const Float projection = pixels[i][0]*axis[0] + pixels[i][1]*axis[1] + pixels[i][2]*axis[2];
+        if(i == 0 || projection < minProjection) {
+            minProjection = projection;
+            minPixel = i;
+        }
+        if(i == 0 || projection > maxProjection) {
+            maxProjection = projection;
+            maxPixel = i;
+        }
+    }
+
+    /* The four-color mode needs the first endpoint to be larger. If both are
+       the same, all indices are zero. */
+    UnsignedShort endpoints[2]{packRgb565(pixels[maxPixel]), packRgb565(pixels[minPixel])};
+    if(endpoints[0] < endpoints[1]) std::swap(endpoints[0], endpoints[1]);
+    UnsignedInt indices = 0;
+    if(endpoints[0] != endpoints[1]) {
+        Int palette[4][3];
+        unpackRgb565(endpoints[0], palette[0]);
+        unpackRgb565(endpoints[1], palette[1]);
+        for(std::size_t c = 0; c != 3; ++c) {
+            palette[2][c] = (2*palette[0][c] + palette[1][c])/3;
+            palette[3][c] = (palette[0][c] + 2*palette[1][c])/3;
+        }
+
+        for(std::size_t i = 0; i != 16; ++i) {
+            UnsignedInt best = 0;
+            Int bestDistance = 0;
+            for(UnsignedInt j = 0; j != 4; ++j) {
+                Int distance = 0;
+                for(std::size_t c = 0; c != 3; ++c)
+                    distance += (pixels[i][c] - palette[j][c])*(pixels[i][c] - palette[j][c]);
+                if(j == 0 || distance < bestDistance) {
+                    bestDistance = distance;
+                    best = j;
+                }
+            }
+            indices |= best << 2*i;
+        }
+    }
+
+    writeLittleEndian(out, endpoints[0], 2);
+    writeLittleEndian(out + 2, endpoints[1], 2);
+    writeLittleEndian(out + 4, indices, 4);
+}
+
+/* Alpha part of a BC3 block, in the eight-value mode */
+void compressAlphaBlock(const UnsignedByte(&pixels)[16][4], char* const out) {
+    UnsignedByte min = 255, max = 0;
+    for(const UnsignedByte* const pixel: pixels) {
+        min = Math::min(min, pixel[3]);
+        max = Math::max(max, pixel[3]);
+    }
+
+    /* Palette is max, min and six values between, in this order. With both
+       endpoints the same all indices are zero. */
+    UnsignedLong indices = 0;
+    if(min != max) {
+        Int palette[8]{max, min};
+        for(Int i = 1; i != 7; ++i)
+            palette[i + 1] = ((7 - i)*max + i*min)/7;
+
+        for(std::size_t i = 0; i != 16; ++i) {
+            UnsignedLong best = 0;
+            for(UnsignedInt j = 1; j != 8; ++j)
+                if(Math::abs(pixels[i][3] - palette[j]) < Math::abs(pixels[i][3] - palette[best]))
+                    best = j;
+            indices |= best << 3*i;
+        }
+    }
+
+    out[0] = char(max);
+    out[1] = char(min);
+    writeLittleEndian(out + 2, indices, 6);
+}
+
+}
+
+void compressBlocks(const char* const pixels, const Vector2i& size, const UnsignedInt pixelSize, char* const out, const Int blockRowBegin, const Int blockRowEnd) {
+    const std::size_t stride = (size.x()*pixelSize + 3)/4*4;
+    const std::size_t blockSize = pixelSize == 4 ? 16 : 8;
+    const Int blockCountX = (size.x() + 3)/4;
+    for(Int blockY = blockRowBegin; blockY != blockRowEnd; ++blockY) {
+        for(Int blockX = 0; blockX != blockCountX; ++blockX) {
+            /* Gather the block, repeating the last row and column on the
+               edges. RGB pixels get an opaque alpha. */
+            UnsignedByte block[16][4];
+            for(Int y = 0; y != 4; ++y) {
+                const auto* const row = reinterpret_cast<const UnsignedByte*>(pixels + Math::min(blockY*4 + y, size.y() - 1)*stride);
+                for(Int x = 0; x != 4; ++x) {
+                    const UnsignedByte* const pixel = row + Math::min(blockX*4 + x, size.x() - 1)*pixelSize;
+                    UnsignedByte* const target = block[y*4 + x];
+                    std::memcpy(target, pixel, pixelSize);
+                    if(pixelSize == 3) target[3] = 255;
+                }
+            }
+
+            char* const blockOut = out + (std::size_t(blockY)*blockCountX + blockX)*blockSize;
+            if(pixelSize == 4) {
+                compressAlphaBlock(block, blockOut);
+                compressColorBlock(block, blockOut + 8);
+            } else compressColorBlock(block, blockOut);
+        }
+    }
+}
+
+}}
@@ -0,0 +1,64 @@
+#ifndef Magnum_Examples_BlockCompression_h
+#define Magnum_Examples_BlockCompression_h
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <cstddef>
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Vector2.h>
+
+namespace Magnum { namespace Examples {
+
+/*
+Simple BC1 and BC3 (also known as DXT1 and DXT5) encoder. The color endpoints
+are the extremes along the principal axis of colors in each 4x4 block, the
+alpha endpoints in BC3 are the alpha extremes. Far from the quality of
+dedicated encoders, but fast enough to run on scene import.
+*/
+
+/** @brief Size of a block-compressed image with given block size in bytes */
+inline std::size_t blockCompressedSize(const Vector2i& size, const UnsignedInt blockSize) {
+    return std::size_t((size.x() + 3)/4)*((size.y() + 3)/4)*blockSize;
+}
+
+/**
+@brief Compress rows of 4x4 blocks
+
+Compresses block rows in range @cpp [blockRowBegin, blockRowEnd) @ce of an
+8-bit-per-channel image with four-byte row alignment. RGB images with
+@p pixelSize @cpp 3 @ce are compressed to BC1 with 8-byte blocks, RGBA images
+with @p pixelSize @cpp 4 @ce to BC3 with 16-byte blocks. Blocks on the edge of
+images with sizes not divisible by four repeat the last pixel. The @p out
+array is expected to have the size of the whole compressed image.
+*/
+void compressBlocks(const char* pixels, const Vector2i& size, UnsignedInt pixelSize, char* out, Int blockRowBegin, Int blockRowEnd);
+
+}}
+
+#endif
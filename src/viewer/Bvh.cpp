@@ -0,0 +1,161 @@
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "Bvh.h"
+
+#include <algorithm>
+#include <Magnum/Math/Functions.h>
+
+namespace Magnum { namespace Examples {
+
+namespace {
+
+/* Leaves with fewer items are cheaper to test one by one than to split */
+constexpr UnsignedInt MaxLeafSize = 4;
+
+}
+
+FrustumPlanes frustumPlanes(const Matrix4& matrix) {
+    const Vector4 x = matrix.row(0);
+    const Vector4 y = matrix.row(1);
+    const Vector4 z = matrix.row(2);
+    const Vector4 w = matrix.row(3);
+    return {{w + x, w - x, w + y, w - y, w + z, w - z}};
+}
+
+Range3D transformBounds(const Matrix4& transformation, const Range3D& bounds) {
+    /* Transform the center and project the half-extent onto each axis of the
+       new space */
+    const Vector3 center = transformation.transformPoint(bounds.center());
+    const Vector3 halfSize = bounds.size()*0.5f;
+    const Matrix3x3 rotationScaling = transformation.rotationScaling();
+    Vector3 newHalfSize;
+    for(std::size_t i = 0; i != 3; ++i)
+        newHalfSize += Math::abs(rotationScaling[i])*halfSize[i];
+    return {center - newHalfSize, center + newHalfSize};
+}
+
+void Bvh::build(const Containers::ArrayView<const Range3D> bounds) {
+    _nodes.clear();
+    _items.resize(bounds.size());
+    if(bounds.empty()) return;
+
+    std::vector<Vector3> centers(bounds.size());
+    for(std::size_t i = 0; i != bounds.size(); ++i) {
+        _items[i] = i;
+        centers[i] = bounds[i].center();
+    }
+
+    /* Every leaf has at least one item, so a binary tree over n items has at
+       most 2n - 1 nodes */
+    _nodes.reserve(2*bounds.size() - 1);
+    buildNode(bounds, centers, 0, bounds.size());
+}
+
+UnsignedInt Bvh::buildNode(const Containers::ArrayView<const Range3D> bounds, const std::vector<Vector3>& centers, const UnsignedInt first, const UnsignedInt count) {
+    const UnsignedInt id = _nodes.size();
+    _nodes.push_back({bounds[_items[first]], first, count, 0});
+
+    /* Bounds of the items and of their centers */
+    Range3D nodeBounds = bounds[_items[first]];
+    Range3D centerBounds{centers[_items[first]], centers[_items[first]]};
+    for(UnsignedInt i = first + 1; i != first + count; ++i) {
+        const Range3D& itemBounds = bounds[_items[i]];
+        nodeBounds = {Math::min(nodeBounds.min(), itemBounds.min()),
+                      Math::max(nodeBounds.max(), itemBounds.max())};
+        centerBounds = {Math::min(centerBounds.min(), centers[_items[i]]),
+                        Math::max(centerBounds.max(), centers[_items[i]])};
+    }
+    _nodes[id].bounds = nodeBounds;
+
+    if(count <= MaxLeafSize) return id;
+
+    /* Split at the median along the longest axis of the centers */
+    const Vector3 centerSize = centerBounds.size();
+    const std::size_t axis = centerSize.x() >= centerSize.y() && centerSize.x() >= centerSize.z() ? 0 :
+        centerSize.y() >= centerSize.z() ? 1 : 2;
+    const UnsignedInt half = count/2;
+    std::nth_element(_items.begin() + first, _items.begin() + first + half, _items.begin() + first + count,
+        [&centers, axis](const UnsignedInt a, const UnsignedInt b) {
+            return centers[a][axis] < centers[b][axis];
+        });
+
+    buildNode(bounds, centers, first, half);
+    const UnsignedInt secondChild = buildNode(bounds, centers, first + half, count - half);
+    _nodes[id].secondChild = secondChild;
+    return id;
+}
+
+std::size_t Bvh::cull(const FrustumPlanes& planes, std::vector<UnsignedInt>& visible) const {
+    visible.clear();
+    std::size_t tested = 0;
+    if(!_nodes.empty()) cullNode(0, planes, (1 << planes.size()) - 1, visible, tested);
+    return tested;
+}
+
+void Bvh::cullNode(const UnsignedInt id, const FrustumPlanes& planes, UnsignedInt planeMask, std::vector<UnsignedInt>& visible, std::size_t& tested) const {
+    const Node& node = _nodes[id];
+    ++tested;
+
+    for(std::size_t i = 0; i != planes.size(); ++i) {
+        if(!(planeMask & (1 << i))) continue;
+
+        /* If the box corner furthest along the plane normal is outside, the
+           whole box is */
+        const Vector4& plane = planes[i];
+        const Vector3 normal = plane.xyz();
+        const Vector3 positive{
+            normal.x() >= 0.0f ? node.bounds.max().x() : node.bounds.min().x(),
+            normal.y() >= 0.0f ? node.bounds.max().y() : node.bounds.min().y(),
+            normal.z() >= 0.0f ? node.bounds.max().z() : node.bounds.min().z()};
+        if(Math::dot(normal, positive) + plane.w() < 0.0f) return;
+
+        /* If the nearest corner is inside, the whole box is and the children
+           don't need to be tested against this plane anymore */
+        const Vector3 negative{
+            normal.x() >= 0.0f ? node.bounds.min().x() : node.bounds.max().x(),
+            normal.y() >= 0.0f ? node.bounds.min().y() : node.bounds.max().y(),
+            normal.z() >= 0.0f ? node.bounds.min().z() : node.bounds.max().z()};
+        if(Math::dot(normal, negative) + plane.w() >= 0.0f)
+            planeMask &= ~(1 << i);
+    }
+
+    /* Completely inside or a leaf, accept everything. For leaves that
+       intersect a plane some items may still be outside, but testing them
+       separately is not worth it. */
+    if(!planeMask || !node.secondChild) {
+        visible.insert(visible.end(), _items.begin() + node.first, _items.begin() + node.first + node.count);
+        return;
+    }
+
+    cullNode(id + 1, planes, planeMask, visible, tested);
+    cullNode(node.secondChild, planes, planeMask, visible, tested);
+}
+
+}}
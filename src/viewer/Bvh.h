@@ -0,0 +1,113 @@
+#ifndef Magnum_Examples_Bvh_h
+#define Magnum_Examples_Bvh_h
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <array>
+#include <vector>
+#include <Corrade/Containers/ArrayView.h>
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Matrix4.h>
+#include <Magnum/Math/Range.h>
+
+namespace Magnum { namespace Examples {
+
+/**
+@brief Frustum planes
+
+Left, right, bottom, top, near and far plane, in this order. Normals point
+inside, points @f$ \boldsymbol{p} @f$ for which
+@f$ \boldsymbol{n} \cdot \boldsymbol{p} + d \ge 0 @f$ are on the inner side.
+*/
+typedef std::array<Vector4, 6> FrustumPlanes;
+
+/**
+@brief Extract frustum planes from a transformation and projection matrix
+
+The planes are in the space the @p matrix transforms from. The planes are not
+normalized, which doesn't matter for inside/outside tests.
+*/
+FrustumPlanes frustumPlanes(const Matrix4& matrix);
+
+/** @brief Axis-aligned bounds of a transformed box */
+Range3D transformBounds(const Matrix4& transformation, const Range3D& bounds);
+
+/**
+@brief Bounding volume hierarchy
+
+Binary tree of axis-aligned boxes built over a static set of items by
+splitting them at the median along the longest axis. Items of each subtree are
+stored contiguously, so when a node is found to be completely inside the
+frustum, all its items are accepted without visiting the children.
+*/
+class Bvh {
+    public:
+        /**
+         * @brief Build the hierarchy
+         *
+         * Item IDs returned by @ref cull() are indices into @p bounds.
+         */
+        void build(Containers::ArrayView<const Range3D> bounds);
+
+        /** @brief Count of items */
+        std::size_t itemCount() const { return _items.size(); }
+
+        /** @brief Count of nodes */
+        std::size_t nodeCount() const { return _nodes.size(); }
+
+        /**
+         * @brief Find items intersecting a frustum
+         *
+         * The @p planes are expected to be in the same space as the bounds
+         * passed to @ref build(). Clears @p visible and fills it with IDs of
+         * items that are inside or intersect the frustum. Returns count of
+         * nodes that were tested.
+         */
+        std::size_t cull(const FrustumPlanes& planes, std::vector<UnsignedInt>& visible) const;
+
+    private:
+        struct Node {
+            Range3D bounds;
+            /* Range in _items covered by this subtree */
+            UnsignedInt first, count;
+            /* Index of the second child or 0 for a leaf, the first child is
+               always right after the parent */
+            UnsignedInt secondChild;
+        };
+
+        UnsignedInt buildNode(Containers::ArrayView<const Range3D> bounds, const std::vector<Vector3>& centers, UnsignedInt first, UnsignedInt count);
+        void cullNode(UnsignedInt id, const FrustumPlanes& planes, UnsignedInt planeMask, std::vector<UnsignedInt>& visible, std::size_t& tested) const;
+
+        std::vector<Node> _nodes;
+        std::vector<UnsignedInt> _items;
+};
+
+}}
+
+#endif
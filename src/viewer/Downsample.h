@@ -0,0 +1,56 @@
+#ifndef Magnum_Examples_Downsample_h
+#define Magnum_Examples_Downsample_h
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Vector2.h>
+
+namespace Magnum { namespace Examples {
+
+/**
+@brief Box-filter rows of the next mip level
+
+Calculates rows @p yBegin to @p yEnd of @p dst, which is expected to be half
+the size of @p src, rounded down and at least one pixel. Both have 8-bit
+channels, @p pixelSize is either @cpp 3 @ce or @cpp 4 @ce and rows are aligned
+to four bytes. With the size rounded down, the last row and column of an
+odd-sized @p src are dropped. Only a @p src that's one pixel wide or tall has
+that pixel used for both pixels of the pair.
+
+Each destination pixel is @f$ (a + b + c + d + 2)/4 @f$ of the four source
+pixels, rounded down. On x86 the pairs are summed four destination pixels at
+a time with SSE2, which gives the same result as the scalar loop used
+elsewhere and for the row ends.
+*/
+void downsample(const char* src, const Vector2i& srcSize, char* dst, const Vector2i& dstSize, UnsignedInt pixelSize, Int yBegin, Int yEnd);
+
+}}
+
+#endif
@@ -0,0 +1,138 @@
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <Corrade/Utility/Arguments.h>
+#include <Magnum/Math/ConfigurationValue.h>
+#include <Magnum/Math/Functions.h>
+
+#include "Downsample.h"
+
+using namespace Magnum;
+using namespace Magnum::Examples;
+
+namespace {
+
+std::size_t rowSize(const Int width, const UnsignedInt pixelSize) {
+    return (width*pixelSize + 3)/4*4;
+}
+
+/* The plain loop PreparedScene used before, one pixel and channel at a
+   time */
+template<UnsignedInt pixelSize> void downsampleReference(const char* const src, const Vector2i& srcSize, char* const dst, const Vector2i& dstSize) {
+    const std::size_t srcStride = rowSize(srcSize.x(), pixelSize);
+    const std::size_t dstStride = rowSize(dstSize.x(), pixelSize);
+    const Int pairCount = srcSize.x()/2;
+    for(Int y = 0; y != dstSize.y(); ++y) {
+        const auto* const row0 = reinterpret_cast<const UnsignedByte*>(src + Math::min(2*y, srcSize.y() - 1)*srcStride);
+        const auto* const row1 = reinterpret_cast<const UnsignedByte*>(src + Math::min(2*y + 1, srcSize.y() - 1)*srcStride);
+        auto* const out = reinterpret_cast<UnsignedByte*>(dst + y*dstStride);
+        for(Int x = 0; x < pairCount; ++x) {
+            const UnsignedByte* const a = row0 + 2*x*pixelSize;
+            const UnsignedByte* const b = row1 + 2*x*pixelSize;
+            for(UnsignedInt c = 0; c != pixelSize; ++c)
+                out[x*pixelSize + c] = (a[c] + a[pixelSize + c] + b[c] + b[pixelSize + c] + 2) >> 2;
+        }
+        if(pairCount != dstSize.x()) {
+            const std::size_t last = (srcSize.x() - 1)*pixelSize;
+            for(UnsignedInt c = 0; c != pixelSize; ++c)
+                out[pairCount*pixelSize + c] = (row0[last + c] + row1[last + c] + 1) >> 1;
+        }
+    }
+}
+
+template<class F> Double minimumTime(const UnsignedInt repeats, F&& f) {
+    Double minimum = 0.0;
+    for(UnsignedInt i = 0; i != repeats; ++i) {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        f();
+        const Double time = std::chrono::duration<double, std::milli>{std::chrono::steady_clock::now() - start}.count();
+        if(!i || time < minimum) minimum = time;
+    }
+    return minimum;
+}
+
+}
+
+/* Compares the mip level downsampling with the plain loop it replaced on a
+   random RGB and RGBA image, on a single thread. The results are expected to
+   be bit-exact. No GL context is needed. */
+int main(int argc, char** argv) {
+    Utility::Arguments args;
+    args.addOption("size", "4096 4096").setHelp("size", "size of the source image", "\"X Y\"")
+        .addOption("repeats", "10").setHelp("repeats", "how many times to downsample each image, the fastest run is reported")
+        .setHelp("Benchmarks box-filtering an image to the next mip level.")
+        .parse(argc, argv);
+
+    const Vector2i size = args.value<Vector2i>("size");
+    const UnsignedInt repeats = args.value<UnsignedInt>("repeats");
+    if(size.x() < 1 || size.y() < 1 || !repeats) {
+        Error{} << "Invalid image size or repeat count";
+        return 1;
+    }
+
+    const Vector2i nextSize = Math::max(size/2, Vector2i{1});
+    std::mt19937 random;
+    bool equal = true;
+    for(const UnsignedInt pixelSize: {3u, 4u}) {
+        std::vector<char> src(rowSize(size.x(), pixelSize)*size.y());
+        for(char& c: src) c = char(random());
+        std::vector<char> dst(rowSize(nextSize.x(), pixelSize)*nextSize.y()),
+            dstReference(dst.size());
+
+        const Double referenceTime = minimumTime(repeats, [&]{
+            if(pixelSize == 3)
+                downsampleReference<3>(src.data(), size, dstReference.data(), nextSize);
+            else
+                downsampleReference<4>(src.data(), size, dstReference.data(), nextSize);
+        });
+        const Double time = minimumTime(repeats, [&]{
+            downsample(src.data(), size, dst.data(), nextSize, pixelSize, 0, nextSize.y());
+        });
+
+        /* Row padding isn't written by either */
+        for(Int y = 0; y != nextSize.y(); ++y) {
+            const std::size_t offset = y*rowSize(nextSize.x(), pixelSize);
+            if(std::memcmp(dst.data() + offset, dstReference.data() + offset, nextSize.x()*pixelSize) != 0) {
+                Error{} << "Results differ for" << pixelSize << "bytes per pixel in row" << y;
+                equal = false;
+                break;
+            }
+        }
+
+        Debug{} << (pixelSize == 3 ? "RGB" : "RGBA") << size << "to" << nextSize
+            << Debug::nospace << ":" << referenceTime << "ms scalar," << time
+            << "ms SIMD," << referenceTime/time << Debug::nospace << "x faster";
+    }
+
+    return equal ? 0 : 2;
+}
@@ -0,0 +1,246 @@
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "Import.h"
+
+#include <algorithm>
+#include <cctype>
+#include <memory>
+#include <vector>
+#include <Corrade/PluginManager/Manager.h>
+#include <Magnum/Mesh.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Trade/AbstractImporter.h>
+#include <Magnum/Trade/MeshObjectData3D.h>
+#include <Magnum/Trade/SceneData.h>
+
+#include "Parallel.h"
+#include "Trace.h"
+
+namespace Magnum { namespace Examples {
+
+namespace {
+
+/* Importer plugins are free to load other plugins on demand (such as
+   AnySceneImporter delegating to AnyImageImporter and that to PngImporter)
+   and the plugin manager isn't thread-safe, so each thread gets its own */
+struct Worker {
+    PluginManager::Manager<Trade::AbstractImporter> manager;
+    std::unique_ptr<Trade::AbstractImporter> importer;
+};
+
+struct Job {
+    enum class Type { Image, Mesh } type;
+    UnsignedInt id;
+};
+
+void importObject(Trade::AbstractImporter& importer, std::vector<ImportedObject>& objects, const Int parent, const UnsignedInt i) {
+    const std::string name = importer.object3DName(i);
+    Debug{} << "Importing object" << i << name;
+    std::unique_ptr<Trade::ObjectData3D> objectData = importer.object3D(i);
+    if(!objectData) {
+        Error{} << "Cannot import object, skipping";
+        return;
+    }
+
+    /* Objects with "occluder" in the name are used for occlusion culling
+       instead of the largest ones */
+    std::string lowercaseName = name;
+    std::transform(name.begin(), name.end(), lowercaseName.begin(), [](char c) {
+        return char(std::tolower(static_cast<unsigned char>(c)));
+    });
+
+    /* Add the object and remember if it has a mesh */
+    const Int id = objects.size();
+    objects.push_back({parent, -1, -1, objectData->transformation(),
+        lowercaseName.find("occluder") != std::string::npos});
+    if(objectData->instanceType() == Trade::ObjectInstanceType3D::Mesh && objectData->instance() != -1) {
+        objects.back().mesh = objectData->instance();
+        objects.back().material = static_cast<Trade::MeshObjectData3D*>(objectData.get())->material();
+    }
+
+    /* Recursively add children */
+    for(std::size_t child: objectData->children())
+        importObject(importer, objects, id, child);
+}
+
+}
+
+ImportedData importData(Trade::AbstractImporter& importer, const std::string& importerPlugin, const std::string& file, UnsignedInt threadCount) {
+    TraceScope traceImport{"import", "import"};
+    ImportedData data;
+
+    /* Flatten the default scene hierarchy first, so we know which meshes and
+       materials are actually needed. Files used as asset libraries can have
+       thousands of them that aren't referenced by anything. */
+    if(importer.defaultScene() != -1) {
+        TraceScope traceScene{"import", "scene hierarchy"};
+        Debug{} << "Importing default scene" << importer.sceneName(importer.defaultScene());
+
+        Containers::Optional<Trade::SceneData> sceneData = importer.scene(importer.defaultScene());
+        if(sceneData) {
+            for(UnsignedInt objectId: sceneData->children3D())
+                importObject(importer, data.objects, -1, objectId);
+        } else Error{} << "Cannot load scene, skipping";
+
+    /* The format has no scene support, display just the first mesh with a
+       default material */
+    } else if(importer.mesh3DCount())
+        data.objects.push_back({-1, 0, -1, Matrix4{}, false});
+
+    /* References to meshes and materials that don't exist are reset, so
+       nothing after this point needs to check them again */
+    std::vector<bool> meshReferenced(importer.mesh3DCount());
+    std::vector<bool> materialReferenced(importer.materialCount());
+    for(ImportedObject& object: data.objects) {
+        if(object.mesh < -1 || object.mesh >= Int(meshReferenced.size())) {
+            Warning{} << "Object references mesh" << object.mesh << "but there are only" << meshReferenced.size() << "meshes, skipping";
+            object.mesh = -1;
+        }
+        if(object.material < -1 || object.material >= Int(materialReferenced.size())) {
+            Warning{} << "Object references material" << object.material << "but there are only" << materialReferenced.size() << "materials, using a default";
+            object.material = -1;
+        }
+        if(object.mesh != -1) meshReferenced[object.mesh] = true;
+        if(object.material != -1) materialReferenced[object.material] = true;
+    }
+
+    /* Materials are cheap to get, import the referenced ones serially. Only
+       Phong materials are supported. Remember which textures they use. */
+    std::vector<bool> textureReferenced(importer.textureCount());
+    data.materials = Containers::Array<Containers::Optional<Trade::PhongMaterialData>>{importer.materialCount()};
+    for(UnsignedInt i = 0; i != importer.materialCount(); ++i) {
+        if(!materialReferenced[i]) continue;
+
+        TraceScope traceMaterial{"import", "material", i};
+        Debug{} << "Importing material" << i << importer.materialName(i);
+
+        std::unique_ptr<Trade::AbstractMaterialData> materialData = importer.material(i);
+        if(!materialData || materialData->type() != Trade::MaterialType::Phong) {
+            Warning{} << "Cannot load material, skipping";
+            continue;
+        }
+
+        Trade::PhongMaterialData& phongMaterialData = static_cast<Trade::PhongMaterialData&>(*materialData);
+        if(phongMaterialData.flags() & Trade::PhongMaterialData::Flag::DiffuseTexture) {
+            if(phongMaterialData.diffuseTexture() >= textureReferenced.size()) {
+                Warning{} << "Material" << i << importer.materialName(i) << "references texture" << phongMaterialData.diffuseTexture() << "but there are only" << textureReferenced.size() << "textures, skipping";
+                continue;
+            }
+            textureReferenced[phongMaterialData.diffuseTexture()] = true;
+        }
+
+        data.materials[i] = std::move(phongMaterialData);
+    }
+
+    /* Texture properties are cheap as well. Remember which images the
+       referenced textures use, only those will get decoded. */
+    std::vector<Job> jobs;
+    std::vector<bool> imageReferenced(importer.image2DCount());
+    data.textures = Containers::Array<Containers::Optional<Trade::TextureData>>{importer.textureCount()};
+    for(UnsignedInt i = 0; i != importer.textureCount(); ++i) {
+        if(!textureReferenced[i]) continue;
+
+        TraceScope traceTexture{"import", "texture", i};
+        Containers::Optional<Trade::TextureData> textureData = importer.texture(i);
+        if(!textureData || textureData->type() != Trade::TextureData::Type::Texture2D) {
+            Warning{} << "Cannot load texture" << i << importer.textureName(i) << "properties, skipping";
+            continue;
+        }
+
+        if(textureData->image() >= importer.image2DCount()) {
+            Warning{} << "Texture" << i << importer.textureName(i) << "references image" << textureData->image() << "but there are only" << importer.image2DCount() << "images, skipping";
+            continue;
+        }
+
+        if(!imageReferenced[textureData->image()]) {
+            imageReferenced[textureData->image()] = true;
+            jobs.push_back({Job::Type::Image, textureData->image()});
+        }
+
+        data.textures[i] = std::move(textureData);
+    }
+
+    data.images = Containers::Array<Containers::Optional<Trade::ImageData2D>>{importer.image2DCount()};
+    data.meshes = Containers::Array<Containers::Optional<Trade::MeshData3D>>{importer.mesh3DCount()};
+    for(UnsignedInt i = 0; i != importer.mesh3DCount(); ++i)
+        if(meshReferenced[i]) jobs.push_back({Job::Type::Mesh, i});
+
+    const std::size_t imageJobCount = std::count_if(jobs.begin(), jobs.end(), [](const Job& job) {
+        return job.type == Job::Type::Image;
+    });
+    Debug{} << "Scene references" << imageJobCount << "of" << importer.image2DCount() << "images and" << jobs.size() - imageJobCount << "of" << importer.mesh3DCount() << "meshes";
+
+    /* Open the file again for each additional thread. If that fails for some
+       reason, continue with what we have. */
+    std::vector<std::unique_ptr<Worker>> workers;
+    threadCount = Math::max(Math::min(threadCount, UnsignedInt(jobs.size())), 1u);
+    for(UnsignedInt i = 1; i < threadCount; ++i) {
+        TraceScope traceOpen{"import", "open file on worker", i};
+        std::unique_ptr<Worker> worker{new Worker};
+        if(!(worker->importer = worker->manager.loadAndInstantiate(importerPlugin)) || !worker->importer->openFile(file)) {
+            Warning{} << "Cannot open the file on a worker thread, importing with" << i << "threads";
+            threadCount = i;
+            break;
+        }
+
+        workers.push_back(std::move(worker));
+    }
+
+    /* Each slot in the output is written by exactly one thread, so there's
+       no need for any locking */
+    parallelFor(threadCount, jobs.size(), [&](const UnsignedInt thread, const std::size_t i) {
+        Trade::AbstractImporter& threadImporter = thread ? *workers[thread - 1]->importer : importer;
+        const Job& job = jobs[i];
+
+        if(job.type == Job::Type::Image) {
+            TraceScope traceImage{"import", "decode image", job.id};
+            data.images[job.id] = threadImporter.image2D(job.id);
+            return;
+        }
+
+        TraceScope traceMesh{"import", "decode mesh", job.id};
+        Containers::Optional<Trade::MeshData3D> meshData = threadImporter.mesh3D(job.id);
+        if(meshData && meshData->hasNormals() && meshData->primitive() == MeshPrimitive::Triangles)
+            data.meshes[job.id] = std::move(meshData);
+    });
+
+    /* Report failures only after all threads are done so the output doesn't
+       get interleaved */
+    for(UnsignedInt i = 0; i != data.images.size(); ++i)
+        if(imageReferenced[i] && !data.images[i])
+            Warning{} << "Cannot load image" << i << importer.image2DName(i);
+    for(UnsignedInt i = 0; i != data.meshes.size(); ++i)
+        if(meshReferenced[i] && !data.meshes[i])
+            Warning{} << "Cannot load mesh" << i << importer.mesh3DName(i);
+
+    return data;
+}
+
+}}
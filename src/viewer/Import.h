@@ -0,0 +1,91 @@
+#ifndef Magnum_Examples_Import_h
+#define Magnum_Examples_Import_h
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <string>
+#include <vector>
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/Optional.h>
+#include <Magnum/Math/Matrix4.h>
+#include <Magnum/Trade/ImageData.h>
+#include <Magnum/Trade/MeshData3D.h>
+#include <Magnum/Trade/PhongMaterialData.h>
+#include <Magnum/Trade/TextureData.h>
+
+namespace Magnum { namespace Examples {
+
+/** @brief Object in a flattened scene hierarchy */
+struct ImportedObject {
+    Int parent;         /**< Parent object index or @cpp -1 @ce for root */
+    Int mesh;           /**< Mesh index or @cpp -1 @ce */
+    Int material;       /**< Material index or @cpp -1 @ce */
+    Matrix4 transformation;
+    /** Whether the object is a designated occluder */
+    bool occluder;
+};
+
+/**
+@brief CPU-side scene data
+
+All arrays except @ref objects are indexed the same way as in the importer,
+items that failed to import or aren't referenced by anything are
+@ref Containers::NullOpt. The @ref objects are the default scene flattened in
+depth-first order, so parents are always before their children. All indices
+are in range --- objects referencing a nonexistent mesh or material get
+@cpp -1 @ce and materials and textures referencing a nonexistent texture or
+image are skipped, so the data can be used without any further checks.
+*/
+struct ImportedData {
+    Containers::Array<Containers::Optional<Trade::TextureData>> textures;
+    Containers::Array<Containers::Optional<Trade::ImageData2D>> images;
+    Containers::Array<Containers::Optional<Trade::PhongMaterialData>> materials;
+    Containers::Array<Containers::Optional<Trade::MeshData3D>> meshes;
+    std::vector<ImportedObject> objects;
+};
+
+/**
+@brief Import the default scene into CPU memory
+
+Expects that @p importer has @p file already opened. The object hierarchy of
+the default scene is imported first and then only materials, textures, images
+and meshes that it references, so startup time and memory scale with what's
+actually shown and not with the size of the file. Materials, texture
+properties and the hierarchy are imported serially through @p importer. The
+images and meshes are then decoded using @p threadCount threads, each
+additional thread opening @p file in its own instance of @p importerPlugin.
+Meshes that don't have normals or aren't triangles are dropped. If the file
+has no scene, a single object referencing the first mesh is added. No GL
+calls are done, so the result can be uploaded afterwards on the GL thread.
+*/
+ImportedData importData(Trade::AbstractImporter& importer, const std::string& importerPlugin, const std::string& file, UnsignedInt threadCount);
+
+}}
+
+#endif
@@ -0,0 +1,137 @@
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "InstancedDrawable.h"
+
+#include <Corrade/Containers/ArrayView.h>
+#include <Magnum/Mesh.h>
+#include <Magnum/Math/Functions.h>
+
+namespace Magnum { namespace Examples {
+
+InstanceBatch::InstanceBatch(InstancedPhongShader& shader, MeshBuffers& mesh, GL::Texture2D* texture, const UnsignedLong sortKey): _shader(shader), _texture{texture}, _sortKey{sortKey}, _quantized{bool(mesh.layout.flags & PreparedMesh::Quantized)}, _lods{mesh.layout.lodCount} {
+    CORRADE_INTERNAL_ASSERT(!texture == !(shader.flags() & InstancedPhongShader::Flag::DiffuseTexture));
+
+    /* Quantized positions are padded to four bytes, attributes are added
+       one by one with the rest of the vertex as a gap after them */
+    const PreparedMesh& layout = mesh.layout;
+    const UnsignedInt positionSize = _quantized ? 8 : sizeof(Vector3);
+    const UnsignedInt normalSize = _quantized ? 4 : sizeof(Vector3);
+    const UnsignedInt textureCoordinatesSize = layout.flags & PreparedMesh::TextureCoordinates ? sizeof(Vector2) : 0;
+    const UnsignedInt stride = positionSize + normalSize + textureCoordinatesSize;
+
+    /* The vertex and index buffers are shared with other batches of the same
+       mesh and all levels of detail, only the instance buffers are ours */
+    for(std::size_t i = 0; i != _lods.size(); ++i) {
+        Lod& lod = _lods[i];
+        lod.triangleCount = MeshPrimitive(layout.primitive) == MeshPrimitive::Triangles ? layout.lods[i].count/3 : 0;
+        lod.error = layout.lods[i].error;
+        lod.mesh.setPrimitive(MeshPrimitive(layout.primitive))
+            .setCount(layout.lods[i].count);
+
+        if(_quantized) lod.mesh
+            .addVertexBuffer(mesh.vertices, 0, InstancedPhongShader::Position{
+                InstancedPhongShader::Position::DataType::UnsignedShort,
+                InstancedPhongShader::Position::DataOption::Normalized}, stride - 6)
+            .addVertexBuffer(mesh.vertices, positionSize, InstancedPhongShader::PackedNormal{
+                InstancedPhongShader::PackedNormal::DataType::Int2101010Rev,
+                InstancedPhongShader::PackedNormal::DataOption::Normalized}, stride - 4);
+        else lod.mesh
+            .addVertexBuffer(mesh.vertices, 0, InstancedPhongShader::Position{}, InstancedPhongShader::Normal{}, textureCoordinatesSize);
+        if(textureCoordinatesSize)
+            lod.mesh.addVertexBuffer(mesh.vertices, positionSize + normalSize, InstancedPhongShader::TextureCoordinates{}, positionSize + normalSize);
+        lod.mesh.addVertexBufferInstanced(lod.instanceBuffer, 1, 0,
+            InstancedPhongShader::TransformationMatrix{},
+            InstancedPhongShader::NormalMatrix{},
+            InstancedPhongShader::Color{});
+
+        if(layout.indexSize)
+            lod.mesh.setIndexBuffer(mesh.indices, layout.lods[i].indexOffset*layout.indexSize,
+                layout.indexSize == 1 ? MeshIndexType::UnsignedByte :
+                layout.indexSize == 2 ? MeshIndexType::UnsignedShort :
+                                        MeshIndexType::UnsignedInt,
+                layout.indexStart, layout.indexEnd);
+    }
+
+    /* Positions are quantized to the mesh bounds, map them back */
+    if(_quantized)
+        _dequantization = Matrix4::translation(layout.bounds.min())*Matrix4::scaling(layout.bounds.size());
+
+    /* Bounding sphere for LOD selection */
+    _center = layout.bounds.center();
+    _radius = layout.bounds.size().length()*0.5f;
+}
+
+UnsignedInt InstanceBatch::selectLod(const Matrix4& transformationMatrix, const Float lodScale) const {
+    if(_lods.size() == 1 || lodScale == 0.0f) return 0;
+
+    /* Camera distance of the bounding sphere, the radius scaled by the
+       largest scale of the transformation. Full detail if the camera is
+       inside. */
+    const Float distance = -transformationMatrix.transformPoint(_center).z();
+    const Float radius = _radius*Math::sqrt(Math::max(Math::max(
+        transformationMatrix[0].xyz().dot(),
+        transformationMatrix[1].xyz().dot()),
+        transformationMatrix[2].xyz().dot()));
+    if(distance <= radius) return 0;
+
+    const Float projectedRadius = radius*lodScale/distance;
+    for(std::size_t i = _lods.size() - 1; i != 0; --i)
+        if(_lods[i].error*projectedRadius <= 1.0f) return i;
+    return 0;
+}
+
+UnsignedInt InstanceBatch::draw() {
+    UnsignedInt drawCalls = 0;
+    for(Lod& lod: _lods) {
+        if(lod.instances.empty()) continue;
+
+        /* Orphan the previous contents so we don't stall on a buffer that's
+           still in use by the previous frame */
+        lod.instanceBuffer.setData(Containers::arrayView(lod.instances.data(), lod.instances.size()), GL::BufferUsage::StreamDraw);
+        lod.instanceBufferSize = lod.instances.size()*sizeof(Instance);
+        lod.mesh.setInstanceCount(lod.instances.size())
+            .draw(_shader);
+        ++drawCalls;
+
+        /* Keep the capacity so the steady state doesn't allocate */
+        lod.instances.clear();
+    }
+
+    _instanceCount = 0;
+    return drawCalls;
+}
+
+void InstanceBatch::trackMemory(MemoryTracker& memory, const std::string& name) const {
+    for(std::size_t i = 0; i != _lods.size(); ++i)
+        if(_lods[i].instanceBufferSize)
+            memory.set(_lods[i].instanceBuffer, name + " instances, LOD " + std::to_string(i), _lods[i].instanceBufferSize);
+}
+
+}}
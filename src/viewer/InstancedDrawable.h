@@ -0,0 +1,171 @@
+#ifndef Magnum_Examples_InstancedDrawable_h
+#define Magnum_Examples_InstancedDrawable_h
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <string>
+#include <vector>
+#include <Corrade/Containers/Array.h>
+#include <Magnum/GL/Buffer.h>
+#include <Magnum/GL/Mesh.h>
+
+#include "InstancedPhongShader.h"
+#include "MemoryTracker.h"
+#include "PreparedScene.h"
+#include "RenderQueue.h"
+
+namespace Magnum { namespace Examples {
+
+/**
+@brief Uploaded mesh buffers
+
+Shared by all batches drawing the same mesh, each batch references them from
+its own @ref GL::Mesh together with its instance buffer.
+*/
+struct MeshBuffers {
+    explicit MeshBuffers(const PreparedMesh& layout): layout(layout), indices{GL::Buffer::TargetHint::ElementArray} {}
+
+    PreparedMesh layout;
+    GL::Buffer vertices, indices;
+};
+
+/**
+@brief Batch of instances of one mesh
+
+Collects per-instance data of all drawables that share the same mesh, shader
+and texture and then draws them all at once. Drawn through a
+@ref RenderQueue, which sets up the shader and binds the texture. Untextured
+materials differ only in the diffuse color, which is a per-instance attribute,
+so they all share one batch. For quantized meshes the dequantization is folded
+into the per-instance transformation matrix. Each level of detail of the mesh
+has its own @ref GL::Mesh and instance buffer.
+*/
+class InstanceBatch {
+    public:
+        /** @brief Per-instance data as laid out in the instance buffer */
+        struct Instance {
+            Matrix4 transformationMatrix;
+            Matrix3x3 normalMatrix;
+            Color4 color;
+        };
+
+        /**
+         * @brief Constructor
+         *
+         * The @p texture is expected to be @cpp nullptr @ce if and only if
+         * @p shader is not textured. The @p sortKey is created with
+         * @ref RenderQueue::sortKey().
+         */
+        explicit InstanceBatch(InstancedPhongShader& shader, MeshBuffers& mesh, GL::Texture2D* texture, UnsignedLong sortKey);
+
+        InstancedPhongShader& shader() { return _shader; }
+
+        /** @brief Diffuse texture or @cpp nullptr @ce */
+        GL::Texture2D* texture() { return _texture; }
+
+        UnsignedLong sortKey() const { return _sortKey; }
+
+        /** @brief Count of levels of detail */
+        UnsignedInt lodCount() const { return _lods.size(); }
+
+        /**
+         * @brief Triangle count of given level of detail
+         *
+         * @cpp 0 @ce for meshes that are not triangles.
+         */
+        UnsignedInt triangleCount(UnsignedInt lod) const {
+            return _lods[lod].triangleCount;
+        }
+
+        /**
+         * @brief Select a level of detail
+         *
+         * Picks the coarsest level whose error, projected on the screen using
+         * the bounding sphere of the mesh, is not larger than one. The
+         * @p lodScale is described in @ref RenderQueue::setLodScale(),
+         * @cpp 0.0f @ce always selects the full detail.
+         */
+        UnsignedInt selectLod(const Matrix4& transformationMatrix, Float lodScale) const;
+
+        /**
+         * @brief Add an instance to be drawn in the next @ref draw()
+         *
+         * Returns @cpp true @ce if this is the first instance since the last
+         * @ref draw().
+         */
+        bool add(const Matrix4& transformationMatrix, const Color4& color, UnsignedInt lod) {
+            /* Quantized positions need to be dequantized first, the normal
+               matrix stays unaffected by that */
+            _lods[lod].instances.push_back({_quantized ? transformationMatrix*_dequantization : transformationMatrix, transformationMatrix.rotationScaling(), color});
+            return ++_instanceCount == 1;
+        }
+
+        /**
+         * @brief Draw all added instances
+         *
+         * Uploads the instance data, draws them with a single draw call for
+         * each used level of detail and clears the lists for the next frame.
+         * Expects that the shader is already set up and the texture bound.
+         * Returns the count of draw calls done, which is @cpp 0 @ce if no
+         * instances were added.
+         */
+        UnsignedInt draw();
+
+        /**
+         * @brief Report instance buffer sizes
+         *
+         * Sets sizes of instance buffers uploaded in the last @ref draw() in
+         * @p memory, prefixing their names with @p name.
+         */
+        void trackMemory(MemoryTracker& memory, const std::string& name) const;
+
+    private:
+        struct Lod {
+            GL::Buffer instanceBuffer;
+            GL::Mesh mesh;
+            std::vector<Instance> instances;
+            std::size_t instanceBufferSize{};
+            UnsignedInt triangleCount;
+            Float error;
+        };
+
+        InstancedPhongShader& _shader;
+        GL::Texture2D* _texture;
+        UnsignedLong _sortKey;
+        bool _quantized;
+        Matrix4 _dequantization;
+        Vector3 _center;
+        Float _radius;
+        std::size_t _instanceCount{};
+        Containers::Array<Lod> _lods;
+};
+
+}}
+
+#endif
@@ -0,0 +1,111 @@
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "InstancedPhongShader.h"
+
+#include <Corrade/Utility/Resource.h>
+#include <Magnum/GL/Buffer.h>
+#include <Magnum/GL/Context.h>
+#include <Magnum/GL/OpenGL.h>
+#include <Magnum/GL/Shader.h>
+#include <Magnum/GL/Texture.h>
+#include <Magnum/GL/Version.h>
+
+namespace Magnum { namespace Examples {
+
+InstancedPhongShader::InstancedPhongShader(const Flags flags): _flags{flags} {
+    #ifndef MAGNUM_TARGET_GLES
+    const GL::Version version = GL::Version::GL330;
+    #else
+    const GL::Version version = GL::Version::GLES300;
+    #endif
+    MAGNUM_ASSERT_GL_VERSION_SUPPORTED(version);
+
+    const Utility::Resource rs{"viewer-data"};
+
+    GL::Shader vert{version, GL::Shader::Type::Vertex};
+    GL::Shader frag{version, GL::Shader::Type::Fragment};
+
+    const std::string preamble = flags & Flag::DiffuseTexture ? "#define DIFFUSE_TEXTURE\n" : "";
+    vert.addSource(preamble)
+        .addSource(rs.get("InstancedPhong.vert"));
+    frag.addSource(preamble)
+        .addSource(rs.get("InstancedPhong.frag"));
+
+    CORRADE_INTERNAL_ASSERT_OUTPUT(GL::Shader::compile({vert, frag}));
+
+    bindAttributeLocation(Position::Location, "position");
+    bindAttributeLocation(Normal::Location, "normal");
+    if(flags & Flag::DiffuseTexture)
+        bindAttributeLocation(TextureCoordinates::Location, "textureCoordinates");
+    bindAttributeLocation(TransformationMatrix::Location, "transformationMatrix");
+    bindAttributeLocation(NormalMatrix::Location, "normalMatrix");
+    bindAttributeLocation(Color::Location, "diffuseColor");
+
+    attachShaders({vert, frag});
+
+    CORRADE_INTERNAL_ASSERT_OUTPUT(link());
+
+    _ambientColorUniform = uniformLocation("ambientColor");
+    _specularColorUniform = uniformLocation("specularColor");
+    _shininessUniform = uniformLocation("shininess");
+
+    /* GLSL 3.30 can't specify the block binding in the shader source */
+    glUniformBlockBinding(id(), glGetUniformBlockIndex(id(), "Frame"), FrameUniformsBinding);
+
+    if(flags & Flag::DiffuseTexture)
+        setUniform(uniformLocation("diffuseTexture"), DiffuseTextureLayer);
+}
+
+InstancedPhongShader& InstancedPhongShader::setAmbientColor(const Color4& color) {
+    setUniform(_ambientColorUniform, color);
+    return *this;
+}
+
+InstancedPhongShader& InstancedPhongShader::setSpecularColor(const Color4& color) {
+    setUniform(_specularColorUniform, color);
+    return *this;
+}
+
+InstancedPhongShader& InstancedPhongShader::setShininess(const Float shininess) {
+    setUniform(_shininessUniform, shininess);
+    return *this;
+}
+
+void InstancedPhongShader::bindFrameUniforms(GL::Buffer& buffer) {
+    buffer.bind(GL::Buffer::Target::Uniform, FrameUniformsBinding);
+}
+
+InstancedPhongShader& InstancedPhongShader::bindDiffuseTexture(GL::Texture2D& texture) {
+    CORRADE_INTERNAL_ASSERT(_flags & Flag::DiffuseTexture);
+    texture.bind(DiffuseTextureLayer);
+    return *this;
+}
+
+}}
@@ -0,0 +1,133 @@
+#ifndef Magnum_Examples_InstancedPhongShader_h
+#define Magnum_Examples_InstancedPhongShader_h
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Corrade/Containers/EnumSet.h>
+#include <Magnum/GL/AbstractShaderProgram.h>
+#include <Magnum/Math/Color.h>
+#include <Magnum/Math/Matrix4.h>
+#include <Magnum/Shaders/Generic.h>
+
+namespace Magnum { namespace Examples {
+
+/**
+@brief Instanced Phong shader
+
+Equivalent to @ref Shaders::Phong with a single light, but the transformation
+matrix, normal matrix and diffuse color are taken from per-instance vertex
+attributes instead of uniforms, so any number of copies of a mesh can be drawn
+with a single draw call. Projection matrix and light position are the same for
+all draws in a frame and are taken from a uniform buffer bound with
+@ref bindFrameUniforms(), shared by all shader instances.
+*/
+class InstancedPhongShader: public GL::AbstractShaderProgram {
+    public:
+        typedef Shaders::Generic3D::Position Position;
+        typedef Shaders::Generic3D::Normal Normal;
+        typedef Shaders::Generic3D::TextureCoordinates TextureCoordinates;
+
+        /**
+         * @brief Normal packed in a four-component format
+         *
+         * Same location as @ref Normal, for use with
+         * @ref GL::Attribute::DataType::Int2101010Rev, which is not
+         * available for three-component attributes. The fourth component is
+         * ignored.
+         */
+        typedef GL::Attribute<Normal::Location, Vector4> PackedNormal;
+
+        /** @brief Per-instance transformation matrix, occupies four locations */
+        typedef GL::Attribute<4, Matrix4> TransformationMatrix;
+
+        /** @brief Per-instance normal matrix, occupies three locations */
+        typedef GL::Attribute<8, Matrix3x3> NormalMatrix;
+
+        /** @brief Per-instance diffuse color, ignored if textured */
+        typedef GL::Attribute<11, Color4> Color;
+
+        enum class Flag: UnsignedByte {
+            DiffuseTexture = 1 << 0     /**< Diffuse texture instead of color */
+        };
+
+        typedef Containers::EnumSet<Flag> Flags;
+
+        /**
+         * @brief Per-frame uniforms
+         *
+         * Matches the std140 layout of the uniform block in the shader.
+         */
+        struct FrameUniforms {
+            Matrix4 projectionMatrix;
+            Vector4 lightPosition;  /**< Camera-space, W is ignored */
+        };
+
+        /**
+         * @brief Bind a buffer with @ref FrameUniforms
+         *
+         * The binding is shared by all instances of this shader, so it's
+         * enough to do it once per frame.
+         */
+        static void bindFrameUniforms(GL::Buffer& buffer);
+
+        explicit InstancedPhongShader(Flags flags = {});
+
+        Flags flags() const { return _flags; }
+
+        /** @brief Set ambient color */
+        InstancedPhongShader& setAmbientColor(const Color4& color);
+
+        /** @brief Set specular color */
+        InstancedPhongShader& setSpecularColor(const Color4& color);
+
+        /** @brief Set shininess */
+        InstancedPhongShader& setShininess(Float shininess);
+
+        /**
+         * @brief Bind diffuse texture
+         *
+         * Expects that the shader was created with @ref Flag::DiffuseTexture.
+         */
+        InstancedPhongShader& bindDiffuseTexture(GL::Texture2D& texture);
+
+    private:
+        enum: Int { DiffuseTextureLayer = 0 };
+        enum: UnsignedInt { FrameUniformsBinding = 0 };
+
+        Flags _flags;
+        Int _ambientColorUniform,
+            _specularColorUniform,
+            _shininessUniform;
+};
+
+CORRADE_ENUMSET_OPERATORS(InstancedPhongShader::Flags)
+
+}}
+
+#endif
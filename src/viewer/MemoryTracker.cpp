@@ -0,0 +1,163 @@
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "MemoryTracker.h"
+
+#include <algorithm>
+#include <sstream>
+#include <Magnum/GL/Buffer.h>
+#include <Magnum/GL/CubeMapTexture.h>
+#include <Magnum/GL/Renderbuffer.h>
+#include <Magnum/GL/Texture.h>
+#ifndef MAGNUM_TARGET_GLES2
+#include <Magnum/GL/TextureArray.h>
+#endif
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Vector3.h>
+
+#include "Trace.h"
+
+namespace Magnum { namespace Examples {
+
+const char* MemoryTracker::typeName(const Type type) {
+    switch(type) {
+        case Type::Buffer: return "buffer";
+        case Type::Texture2D: return "texture2D";
+        case Type::Texture2DArray: return "texture2DArray";
+        case Type::CubeMapTexture: return "cubeMapTexture";
+        case Type::Renderbuffer: return "renderbuffer";
+        case Type::CpuData: return "cpuData";
+    }
+
+    CORRADE_ASSERT_UNREACHABLE();
+}
+
+std::size_t MemoryTracker::textureSize(const Vector3i& size, const UnsignedInt levelCount, const UnsignedInt pixelSize) {
+    std::size_t out = 0;
+    for(UnsignedInt i = 0; i != levelCount; ++i) {
+        const Vector2i levelSize = Math::max(size.xy() >> i, Vector2i{1});
+        out += std::size_t(levelSize.product())*size.z()*pixelSize;
+    }
+    return out;
+}
+
+void MemoryTracker::set(const Type type, const std::uintptr_t id, std::string name, const std::size_t size) {
+    const auto inserted = _entries.emplace(std::make_pair(type, id), Entry{type, id, {}, 0});
+    Entry& entry = inserted.first->second;
+    if(inserted.second) ++_counts[std::size_t(type)];
+    else {
+        _totals[std::size_t(type)] -= entry.size;
+        _total -= entry.size;
+    }
+
+    entry.name = std::move(name);
+    entry.size = size;
+    _totals[std::size_t(type)] += size;
+    _total += size;
+    _peak = Math::max(_peak, _total);
+}
+
+void MemoryTracker::set(const GL::Buffer& buffer, std::string name, const std::size_t size) {
+    set(Type::Buffer, buffer.id(), std::move(name), size);
+}
+
+void MemoryTracker::set(const GL::Texture2D& texture, std::string name, const std::size_t size) {
+    set(Type::Texture2D, texture.id(), std::move(name), size);
+}
+
+#ifndef MAGNUM_TARGET_GLES2
+void MemoryTracker::set(const GL::Texture2DArray& texture, std::string name, const std::size_t size) {
+    set(Type::Texture2DArray, texture.id(), std::move(name), size);
+}
+#endif
+
+void MemoryTracker::set(const GL::CubeMapTexture& texture, std::string name, const std::size_t size) {
+    set(Type::CubeMapTexture, texture.id(), std::move(name), size);
+}
+
+void MemoryTracker::set(const GL::Renderbuffer& renderbuffer, std::string name, const std::size_t size) {
+    set(Type::Renderbuffer, renderbuffer.id(), std::move(name), size);
+}
+
+void MemoryTracker::remove(const Type type, const std::uintptr_t id) {
+    const auto found = _entries.find({type, id});
+    if(found == _entries.end()) return;
+
+    _totals[std::size_t(type)] -= found->second.size;
+    --_counts[std::size_t(type)];
+    _total -= found->second.size;
+    _entries.erase(found);
+}
+
+std::vector<const MemoryTracker::Entry*> MemoryTracker::largest(const std::size_t count) const {
+    std::vector<const Entry*> out;
+    out.reserve(_entries.size());
+    for(const auto& entry: _entries) out.push_back(&entry.second);
+
+    const std::size_t n = Math::min(count, out.size());
+    std::partial_sort(out.begin(), out.begin() + n, out.end(), [](const Entry* a, const Entry* b) {
+        return a->size > b->size;
+    });
+    out.resize(n);
+    return out;
+}
+
+void MemoryTracker::print(const std::size_t count) const {
+    Debug{} << "Memory used by" << _entries.size() << "resources:" << _total/1024 << "kB, peak" << _peak/1024 << "kB";
+    for(std::size_t i = 0; i != TypeCount; ++i) if(_counts[i])
+        Debug{} << "  " << Debug::nospace << typeName(Type(i)) << Debug::nospace << ":" << _totals[i]/1024 << "kB in" << _counts[i];
+    Debug{} << "Largest resources:";
+    for(const Entry* entry: largest(count))
+        Debug{} << "  " << Debug::nospace << entry->size/1024 << "kB" << typeName(entry->type) << entry->name;
+}
+
+std::string MemoryTracker::json(const std::size_t count) const {
+    std::ostringstream out;
+    out << "{\n"
+        << "  \"total\": " << _total << ",\n"
+        << "  \"peak\": " << _peak << ",\n"
+        << "  \"count\": " << _entries.size() << ",\n"
+        << "  \"types\": {";
+    for(std::size_t i = 0; i != TypeCount; ++i) {
+        out << (i ? ",\n" : "\n")
+            << "    \"" << typeName(Type(i)) << "\": {\"total\": " << _totals[i] << ", \"count\": " << _counts[i] << "}";
+    }
+    out << "\n  },\n"
+        << "  \"largest\": [";
+    const std::vector<const Entry*> entries = largest(count);
+    for(std::size_t i = 0; i != entries.size(); ++i) {
+        out << (i ? ",\n" : "\n")
+            << "    {\"type\": \"" << typeName(entries[i]->type) << "\", \"name\": \"" << jsonEscape(entries[i]->name) << "\", \"size\": " << entries[i]->size << "}";
+    }
+    out << (entries.empty() ? "" : "\n  ") << "]\n"
+        << "}\n";
+    return out.str();
+}
+
+}}
@@ -0,0 +1,279 @@
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <unordered_map>
+
+namespace Magnum { namespace Examples {
+
+namespace {
+
+constexpr Int CacheSize = 32;
+
+/* Score of a vertex based on its position in the LRU cache and count of
+   triangles that still need to be emitted. The constants are the ones
+   suggested in the original article. */
+Float vertexScore(const Int cachePosition, const UnsignedInt remainingTriangles) {
+    /* No triangles left, the vertex doesn't matter anymore */
+    if(!remainingTriangles) return -1.0f;
+
+    Float score = 0.0f;
+    if(cachePosition >= 0) {
+        /* Vertices of the last triangle get a fixed score so the algorithm
+           doesn't prefer emitting the same triangle strip direction
+           forever */
+        if(cachePosition < 3) score = 0.75f;
+        else score = std::pow(1.0f - Float(cachePosition - 3)/(CacheSize - 3), 1.5f);
+    }
+
+    /* Boost vertices with only a few triangles left so lone triangles don't
+       get left behind and cause cache misses later */
+    return score + 2.0f/std::sqrt(Float(remainingTriangles));
+}
+
+}
+
+void optimizeVertexCache(const Containers::ArrayView<UnsignedInt> indices, const UnsignedInt vertexCount) {
+    const std::size_t triangleCount = indices.size()/3;
+    if(triangleCount < 2) return;
+
+    /* Triangles using each vertex, packed into a single array. The first
+       remaining[v] entries of each vertex list are triangles that weren't
+       emitted yet. */
+    std::vector<UnsignedInt> remaining(vertexCount);
+    for(const UnsignedInt index: indices) ++remaining[index];
+    std::vector<UnsignedInt> adjacencyOffsets(vertexCount + 1);
+    for(std::size_t i = 0; i != vertexCount; ++i)
+        adjacencyOffsets[i + 1] = adjacencyOffsets[i] + remaining[i];
+    std::vector<UnsignedInt> adjacency(triangleCount*3);
+    {
+        std::vector<UnsignedInt> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for(std::size_t i = 0; i != triangleCount*3; ++i)
+            adjacency[fill[indices[i]]++] = i/3;
+    }
+
+    /* Initial scores, nothing is in the cache yet */
+    std::vector<Int> cachePositions(vertexCount, -1);
+    std::vector<Float> vertexScores(vertexCount);
+    for(std::size_t i = 0; i != vertexCount; ++i)
+        vertexScores[i] = vertexScore(-1, remaining[i]);
+    std::vector<Float> triangleScores(triangleCount);
+    Int best = 0;
+    for(std::size_t i = 0; i != triangleCount; ++i) {
+        triangleScores[i] = vertexScores[indices[i*3]] + vertexScores[indices[i*3 + 1]] + vertexScores[indices[i*3 + 2]];
+        if(triangleScores[i] > triangleScores[best]) best = i;
+    }
+
+    std::vector<bool> emitted(triangleCount);
+    std::vector<UnsignedInt> out;
+    out.reserve(triangleCount*3);
+    UnsignedInt cache[CacheSize + 3];
+    UnsignedInt nextCache[CacheSize + 3];
+    std::size_t cacheCount = 0;
+    std::size_t nextUnemitted = 0;
+    while(best != -1) {
+        emitted[best] = true;
+        const UnsignedInt* const triangle = indices.data() + best*3;
+        out.insert(out.end(), triangle, triangle + 3);
+
+        /* Remove the triangle from the remaining lists of its vertices */
+        for(std::size_t i = 0; i != 3; ++i) {
+            const UnsignedInt vertex = triangle[i];
+            UnsignedInt* const begin = adjacency.data() + adjacencyOffsets[vertex];
+            UnsignedInt* const end = begin + remaining[vertex];
+            std::iter_swap(std::find(begin, end, UnsignedInt(best)), end - 1);
+            --remaining[vertex];
+        }
+
+        /* Move vertices of the triangle to the front of the cache. Degenerate
+           triangles can reference the same vertex more than once. */
+        std::size_t nextCacheCount = 0;
+        for(std::size_t i = 0; i != 3; ++i)
+            if(std::find(nextCache, nextCache + nextCacheCount, triangle[i]) == nextCache + nextCacheCount)
+                nextCache[nextCacheCount++] = triangle[i];
+        for(std::size_t i = 0; i != cacheCount; ++i)
+            if(cache[i] != triangle[0] && cache[i] != triangle[1] && cache[i] != triangle[2])
+                nextCache[nextCacheCount++] = cache[i];
+
+        /* Update scores of all vertices that were touched, including the ones
+           that just fell out of the cache, and propagate the difference to
+           the remaining triangles */
+        for(std::size_t i = 0; i != nextCacheCount; ++i) {
+            const UnsignedInt vertex = nextCache[i];
+            cachePositions[vertex] = i < CacheSize ? i : -1;
+            const Float score = vertexScore(cachePositions[vertex], remaining[vertex]);
+            const Float delta = score - vertexScores[vertex];
+            vertexScores[vertex] = score;
+            for(std::size_t j = 0; j != remaining[vertex]; ++j)
+                triangleScores[adjacency[adjacencyOffsets[vertex] + j]] += delta;
+        }
+        cacheCount = Math::min(nextCacheCount, std::size_t(CacheSize));
+        std::copy(nextCache, nextCache + cacheCount, cache);
+
+        /* The best next triangle is almost always one using a vertex in the
+           cache, so look only there */
+        best = -1;
+        Float bestScore = -1.0f;
+        for(std::size_t i = 0; i != cacheCount; ++i) {
+            const UnsignedInt vertex = cache[i];
+            for(std::size_t j = 0; j != remaining[vertex]; ++j) {
+                const UnsignedInt candidate = adjacency[adjacencyOffsets[vertex] + j];
+                if(triangleScores[candidate] > bestScore) {
+                    best = candidate;
+                    bestScore = triangleScores[candidate];
+                }
+            }
+        }
+
+        /* Nothing in the cache has any triangles left, continue with the
+           first triangle that wasn't emitted yet */
+        if(best == -1) {
+            while(nextUnemitted != triangleCount && emitted[nextUnemitted])
+                ++nextUnemitted;
+            if(nextUnemitted != triangleCount) best = nextUnemitted;
+        }
+    }
+
+    std::copy(out.begin(), out.end(), indices.begin());
+}
+
+UnsignedInt optimizeVertexFetch(const Containers::ArrayView<UnsignedInt> indices, const Containers::ArrayView<UnsignedInt> remapping) {
+    std::fill(remapping.begin(), remapping.end(), 0xffffffffu);
+
+    UnsignedInt vertexCount = 0;
+    for(UnsignedInt& index: indices) {
+        if(remapping[index] == 0xffffffffu)
+            remapping[index] = vertexCount++;
+        index = remapping[index];
+    }
+
+    return vertexCount;
+}
+
+UnsignedInt clusterVertices(const Containers::ArrayView<const Vector3> positions, const Range3D& bounds, const Float cellSize, const Containers::ArrayView<UnsignedInt> clusters) {
+    /* Cell coordinates packed into 21 bits each, the caller is not expected
+       to use grids finer than that */
+    std::unordered_map<UnsignedLong, UnsignedInt> cells;
+    for(std::size_t i = 0; i != positions.size(); ++i) {
+        const Vector3ui cell{Math::min((positions[i] - bounds.min())/cellSize, Vector3{(1 << 21) - 1})};
+        const UnsignedLong key = UnsignedLong(cell.x()) << 42 | UnsignedLong(cell.y()) << 21 | cell.z();
+        clusters[i] = cells.emplace(key, UnsignedInt(cells.size())).first->second;
+    }
+
+    return cells.size();
+}
+
+UnsignedInt connectedComponents(const Containers::ArrayView<const UnsignedInt> indices, const Containers::ArrayView<UnsignedInt> components) {
+    /* Union-find, with each triangle joining its vertices into the set of
+       the first one */
+    for(std::size_t i = 0; i != components.size(); ++i) components[i] = i;
+    auto find = [&](UnsignedInt i) {
+        while(components[i] != i) i = components[i] = components[components[i]];
+        return i;
+    };
+    for(std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+        const UnsignedInt root = find(indices[i]);
+        components[find(indices[i + 1])] = root;
+        components[find(indices[i + 2])] = root;
+    }
+
+    /* Point every vertex directly to its root and then number the roots
+       consecutively */
+    for(std::size_t i = 0; i != components.size(); ++i)
+        components[i] = find(i);
+    std::vector<UnsignedInt> ids(components.size(), ~UnsignedInt{});
+    UnsignedInt count = 0;
+    for(std::size_t i = 0; i != components.size(); ++i) {
+        UnsignedInt& id = ids[components[i]];
+        if(id == ~UnsignedInt{}) id = count++;
+        components[i] = id;
+    }
+
+    return count;
+}
+
+UnsignedInt splitClusters(const Containers::ArrayView<const UnsignedInt> clusters, const Containers::ArrayView<const UnsignedInt> components, const Containers::ArrayView<UnsignedInt> parts) {
+    std::unordered_map<UnsignedLong, UnsignedInt> unique;
+    for(std::size_t i = 0; i != clusters.size(); ++i) {
+        const UnsignedLong key = UnsignedLong(clusters[i]) << 32 | components[i];
+        parts[i] = unique.emplace(key, UnsignedInt(unique.size())).first->second;
+    }
+
+    return unique.size();
+}
+
+std::vector<UnsignedInt> remapTriangles(const Containers::ArrayView<const UnsignedInt> indices, const Containers::ArrayView<const UnsignedInt> clusters) {
+    /* Rotate each triangle so the smallest index is first, which preserves
+       the winding but makes duplicates compare equal */
+    std::vector<std::array<UnsignedInt, 3>> triangles;
+    triangles.reserve(indices.size()/3);
+    for(std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+        std::array<UnsignedInt, 3> triangle{{clusters[indices[i]], clusters[indices[i + 1]], clusters[indices[i + 2]]}};
+        if(triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[0] == triangle[2])
+            continue;
+        std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+        triangles.push_back(triangle);
+    }
+
+    /* The order doesn't matter, it gets optimized for the vertex cache
+       afterwards anyway */
+    std::sort(triangles.begin(), triangles.end());
+    triangles.erase(std::unique(triangles.begin(), triangles.end()), triangles.end());
+
+    std::vector<UnsignedInt> out;
+    out.reserve(triangles.size()*3);
+    for(const std::array<UnsignedInt, 3>& triangle: triangles)
+        out.insert(out.end(), triangle.begin(), triangle.end());
+    return out;
+}
+
+Float averageCacheMissRatio(const Containers::ArrayView<const UnsignedInt> indices, const UnsignedInt vertexCount, const UnsignedInt cacheSize) {
+    if(indices.size() < 3) return 0.0f;
+
+    /* A vertex is in the FIFO cache if less than cacheSize other vertices
+       were loaded since it was loaded. Starting the clock at cacheSize + 1
+       makes the initial zero timestamps miss. */
+    std::vector<UnsignedInt> timestamps(vertexCount);
+    UnsignedInt time = cacheSize + 1;
+    std::size_t misses = 0;
+    for(const UnsignedInt index: indices) {
+        if(time - timestamps[index] > cacheSize) {
+            timestamps[index] = time++;
+            ++misses;
+        }
+    }
+
+    return Float(misses)/(indices.size()/3);
+}
+
+}}
@@ -0,0 +1,147 @@
+#ifndef Magnum_Examples_MeshOptimizer_h
+#define Magnum_Examples_MeshOptimizer_h
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vector>
+#include <Corrade/Containers/ArrayView.h>
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Range.h>
+
+namespace Magnum { namespace Examples {
+
+/**
+@brief Reorder triangles for the post-transform vertex cache
+
+Greedy algorithm by Tom Forsyth, "Linear-Speed Vertex Cache Optimisation",
+picking next the triangle whose vertices are either in a simulated LRU cache or
+have only a few remaining triangles left, so the mesh gets processed in compact
+strips that reuse already transformed vertices. Expects triangle indices, all
+of them lower than @p vertexCount.
+*/
+void optimizeVertexCache(Containers::ArrayView<UnsignedInt> indices, UnsignedInt vertexCount);
+
+/**
+@brief Reorder vertices for fetch locality
+
+Renumbers the vertices in order of their first use in @p indices, so the GPU
+reads the vertex buffer mostly sequentially. Run after
+@ref optimizeVertexCache(). Fills @p remapping, which is expected to have one
+item for every vertex, with the new index of each vertex or
+@cpp 0xffffffffu @ce for vertices that aren't used at all. Returns the count of
+used vertices.
+*/
+UnsignedInt optimizeVertexFetch(Containers::ArrayView<UnsignedInt> indices, Containers::ArrayView<UnsignedInt> remapping);
+
+/**
+@brief Average cache miss ratio
+
+Count of vertex shader invocations per triangle on a FIFO cache of
+@p cacheSize vertices. Equals @cpp 3.0f @ce for a mesh with no vertex reuse,
+the ideal for a regular grid approaches @cpp 0.5f @ce.
+*/
+Float averageCacheMissRatio(Containers::ArrayView<const UnsignedInt> indices, UnsignedInt vertexCount, UnsignedInt cacheSize = 16);
+
+/**
+@brief Cluster vertices on a uniform grid
+
+Simplification by vertex clustering, as described by Rossignac and Borrel,
+"Multi-resolution 3D approximations for rendering complex scenes". Puts all
+vertices that fall into the same cell of a grid with given @p cellSize,
+starting at @cpp bounds.min() @ce, into one cluster. Fills @p clusters, which
+is expected to have one item for every vertex, with cluster ID of each vertex
+and returns the count of clusters. The maximal error introduced by merging all
+vertices of a cluster into one is the cell diagonal.
+*/
+UnsignedInt clusterVertices(Containers::ArrayView<const Vector3> positions, const Range3D& bounds, Float cellSize, Containers::ArrayView<UnsignedInt> clusters);
+
+/**
+@brief Connected components of a triangle mesh
+
+Fills @p components, which is expected to have one item for every vertex,
+with the ID of the component each vertex belongs to, two vertices being in
+the same component if a chain of triangles connects them. Returns the count
+of components. Texture seams and hard edges are made by duplicating vertices,
+so each side of them ends up in a different component.
+*/
+UnsignedInt connectedComponents(Containers::ArrayView<const UnsignedInt> indices, Containers::ArrayView<UnsignedInt> components);
+
+/**
+@brief Split vertex clusters into connected parts
+
+Splits each cluster from @ref clusterVertices() into parts that belong to
+different @p components from @ref connectedComponents(), so vertices on
+different sides of a texture seam don't get merged. Fills @p parts, which is
+expected to have one item for every vertex, and returns the count of parts.
+*/
+UnsignedInt splitClusters(Containers::ArrayView<const UnsignedInt> clusters, Containers::ArrayView<const UnsignedInt> components, Containers::ArrayView<UnsignedInt> parts);
+
+/**
+@brief Remap triangles to vertex clusters
+
+Replaces each index with its cluster from @ref clusterVertices() and removes
+triangles that became degenerate or duplicate in the process.
+*/
+std::vector<UnsignedInt> remapTriangles(Containers::ArrayView<const UnsignedInt> indices, Containers::ArrayView<const UnsignedInt> clusters);
+
+/**
+@brief Pack a normal to a signed normalized 10-10-10-2 value
+
+Matches @ref GL::Attribute::DataType::Int2101010Rev. The last component is
+zero.
+*/
+inline UnsignedInt packNormal(const Vector3& normal) {
+    UnsignedInt out = 0;
+    for(std::size_t i = 0; i != 3; ++i) {
+        const Int value = Int(Math::round(Math::clamp(normal[i], -1.0f, 1.0f)*511.0f));
+        out |= (UnsignedInt(value) & 0x3ff) << (10*i);
+    }
+    return out;
+}
+
+/**
+@brief Quantize a position to 16-bit unsigned normalized value
+
+The @p bounds are mapped to the @f$ [0, 65535] @f$ range, the dequantization
+is then a translation to @cpp bounds.min() @ce scaled by
+@cpp bounds.size() @ce.
+*/
+inline Math::Vector3<UnsignedShort> quantizePosition(const Vector3& position, const Range3D& bounds) {
+    /* Flat meshes have a zero size in one axis, all values are 0 there */
+    const Vector3 size = bounds.size();
+    Math::Vector3<UnsignedShort> out;
+    for(std::size_t i = 0; i != 3; ++i)
+        out[i] = size[i] > 0.0f ? UnsignedShort(Math::round(Math::clamp((position[i] - bounds.min()[i])/size[i], 0.0f, 1.0f)*65535.0f)) : 0;
+    return out;
+}
+
+}}
+
+#endif
@@ -0,0 +1,255 @@
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "OcclusionBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <Magnum/Math/Constants.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Matrix4.h>
+#include <Magnum/Math/Range.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MAGNUM_EXAMPLES_OCCLUSION_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace Magnum { namespace Examples {
+
+namespace {
+
+/* Vertices closer than this are treated as crossing the near plane, which
+   avoids clipping them */
+constexpr Float MinW = 1.0e-5f;
+
+/* Depth test and write one row of a triangle. The edge functions and the
+   depth are given at the first pixel and increase by a and za with each
+   pixel. The SSE2 path evaluates them in the same order as the scalar loop,
+   so both write the same values. */
+void rasterizeRow(Float* const row, const Int width, const Float (&e)[3], const Float (&a)[3], const Float z, const Float za) {
+    Int x = 0;
+
+    #ifdef MAGNUM_EXAMPLES_OCCLUSION_SSE2
+    /* GCC vectorizes the scalar loop only at -O3, so it's done by hand */
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 e0 = _mm_set1_ps(e[0]), e1 = _mm_set1_ps(e[1]), e2 = _mm_set1_ps(e[2]);
+    const __m128 a0 = _mm_set1_ps(a[0]), a1 = _mm_set1_ps(a[1]), a2 = _mm_set1_ps(a[2]);
+    const __m128 z0 = _mm_set1_ps(z), dz = _mm_set1_ps(za);
+    /* Converting an integer counter keeps the float adds off the loop
+       dependency chain */
+    __m128i ix = _mm_setr_epi32(0, 1, 2, 3);
+    const __m128i four = _mm_set1_epi32(4);
+    for(; x + 4 <= width; x += 4) {
+        const __m128 fx = _mm_cvtepi32_ps(ix);
+        const __m128 inside = _mm_and_ps(_mm_and_ps(
+            _mm_cmpge_ps(_mm_add_ps(e0, _mm_mul_ps(a0, fx)), zero),
+            _mm_cmpge_ps(_mm_add_ps(e1, _mm_mul_ps(a1, fx)), zero)),
+            _mm_cmpge_ps(_mm_add_ps(e2, _mm_mul_ps(a2, fx)), zero));
+        const __m128 pixelZ = _mm_add_ps(z0, _mm_mul_ps(dz, fx));
+        const __m128 previous = _mm_loadu_ps(row + x);
+        const __m128 write = _mm_and_ps(inside, _mm_cmpgt_ps(pixelZ, previous));
+        _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(write, pixelZ), _mm_andnot_ps(write, previous)));
+        ix = _mm_add_epi32(ix, four);
+    }
+    #endif
+
+    /* The remainder or everything on other platforms */
+    for(; x < width; ++x) {
+        const Float fx = Float(x);
+        const bool inside = (e[0] + a[0]*fx >= 0.0f) &
+                            (e[1] + a[1]*fx >= 0.0f) &
+                            (e[2] + a[2]*fx >= 0.0f);
+        const Float pixelZ = z + za*fx;
+        row[x] = inside & (pixelZ > row[x]) ? pixelZ : row[x];
+    }
+}
+
+}
+
+OcclusionBuffer::OcclusionBuffer(const Vector2i& size) {
+    /* Each level has half the size of the previous one, rounded up, so every
+       texel of a level corresponds to exactly a 2x2 block of the previous */
+    std::size_t offset = 0;
+    Vector2i levelSize = size;
+    for(;;) {
+        _levels.push_back({levelSize, offset});
+        offset += levelSize.product();
+        if(levelSize == Vector2i{1}) break;
+        levelSize = (levelSize + Vector2i{1})/2;
+    }
+
+    _data.resize(offset);
+}
+
+void OcclusionBuffer::clear() {
+    std::fill_n(_data.begin(), size().product(), 0.0f);
+}
+
+std::size_t OcclusionBuffer::rasterize(const Matrix4& transformationProjectionMatrix, const Containers::ArrayView<const Vector3> triangles) {
+    const Vector2i size = this->size();
+    const Vector2 scale = Vector2{size}*0.5f;
+    Float* const depth = _data.data();
+
+    std::size_t rasterized = 0;
+    for(std::size_t i = 0; i + 2 < triangles.size(); i += 3) {
+        /* Project to pixel coordinates, Z is the reciprocal W */
+        Vector3 v[3];
+        bool behind = false;
+        for(std::size_t j = 0; j != 3; ++j) {
+            const Vector4 clip = transformationProjectionMatrix*Vector4{triangles[i + j], 1.0f};
+            if(clip.w() < MinW) {
+                behind = true;
+                break;
+            }
+
+            const Float invW = 1.0f/clip.w();
+            v[j] = {(clip.x()*invW + 1.0f)*scale.x(),
+                    (clip.y()*invW + 1.0f)*scale.y(), invW};
+        }
+        if(behind) continue;
+
+        /* Twice the signed area, flip clockwise triangles so the edge
+           functions are positive inside for both windings */
+        Float area = (v[1].x() - v[0].x())*(v[2].y() - v[0].y()) -
+                     (v[2].x() - v[0].x())*(v[1].y() - v[0].y());
+        if(area == 0.0f) continue;
+        if(area < 0.0f) {
+            std::swap(v[1], v[2]);
+            area = -area;
+        }
+
+        /* Pixels with centers inside the bounding box, clamped to the
+           buffer */
+        const Int minX = Math::max(Int(std::ceil(Math::min(Math::min(v[0].x(), v[1].x()), v[2].x()) - 0.5f)), 0);
+        const Int maxX = Math::min(Int(std::floor(Math::max(Math::max(v[0].x(), v[1].x()), v[2].x()) - 0.5f)), size.x() - 1);
+        const Int minY = Math::max(Int(std::ceil(Math::min(Math::min(v[0].y(), v[1].y()), v[2].y()) - 0.5f)), 0);
+        const Int maxY = Math::min(Int(std::floor(Math::max(Math::max(v[0].y(), v[1].y()), v[2].y()) - 0.5f)), size.y() - 1);
+        if(minX > maxX || minY > maxY) continue;
+
+        /* Edge functions a*x + b*y + c, each edge opposite to one vertex.
+           Normalized by the area they're the barycentric coordinates, which
+           interpolate the depth. */
+        Float a[3], b[3], c[3];
+        for(std::size_t j = 0; j != 3; ++j) {
+            const Vector3& from = v[(j + 1) % 3];
+            const Vector3& to = v[(j + 2) % 3];
+            a[j] = from.y() - to.y();
+            b[j] = to.x() - from.x();
+            c[j] = -a[j]*from.x() - b[j]*from.y();
+        }
+        const Float za = (a[0]*v[0].z() + a[1]*v[1].z() + a[2]*v[2].z())/area;
+        const Float zb = (b[0]*v[0].z() + b[1]*v[1].z() + b[2]*v[2].z())/area;
+        const Float zc = (c[0]*v[0].z() + c[1]*v[1].z() + c[2]*v[2].z())/area;
+
+        const Float x0 = minX + 0.5f;
+        const Int width = maxX - minX + 1;
+        for(Int y = minY; y <= maxY; ++y) {
+            const Float y0 = y + 0.5f;
+            const Float e[3]{
+                a[0]*x0 + b[0]*y0 + c[0],
+                a[1]*x0 + b[1]*y0 + c[1],
+                a[2]*x0 + b[2]*y0 + c[2]};
+            rasterizeRow(depth + std::size_t(y)*size.x() + minX, width, e, a, za*x0 + zb*y0 + zc, za);
+        }
+
+        ++rasterized;
+    }
+
+    return rasterized;
+}
+
+void OcclusionBuffer::buildPyramid() {
+    for(std::size_t i = 1; i < _levels.size(); ++i) {
+        const Level& source = _levels[i - 1];
+        const Level& target = _levels[i];
+        const Float* const in = _data.data() + source.offset;
+        Float* const out = _data.data() + target.offset;
+        for(Int y = 0; y != target.size.y(); ++y) {
+            /* Odd sizes repeat the last row or column */
+            const Float* const row0 = in + std::size_t(2*y)*source.size.x();
+            const Float* const row1 = in + std::size_t(Math::min(2*y + 1, source.size.y() - 1))*source.size.x();
+            for(Int x = 0; x != target.size.x(); ++x) {
+                const Int x0 = 2*x, x1 = Math::min(2*x + 1, source.size.x() - 1);
+                out[std::size_t(y)*target.size.x() + x] = Math::min(
+                    Math::min(row0[x0], row0[x1]),
+                    Math::min(row1[x0], row1[x1]));
+            }
+        }
+    }
+}
+
+bool OcclusionBuffer::isVisible(const Matrix4& transformationProjectionMatrix, const Range3D& bounds) const {
+    const Vector2i size = this->size();
+    const Vector2 scale = Vector2{size}*0.5f;
+
+    /* Screen rectangle of the box and its closest point. W is linear in the
+       position, so the closest point is one of the corners. */
+    Vector2 min{Constants::inf()}, max{-Constants::inf()};
+    Float closest = 0.0f;
+    for(std::size_t i = 0; i != 8; ++i) {
+        const Vector3 corner{
+            (i & 1 ? bounds.max() : bounds.min()).x(),
+            (i & 2 ? bounds.max() : bounds.min()).y(),
+            (i & 4 ? bounds.max() : bounds.min()).z()};
+        const Vector4 clip = transformationProjectionMatrix*Vector4{corner, 1.0f};
+        if(clip.w() < MinW) return true;
+
+        const Float invW = 1.0f/clip.w();
+        const Vector2 screen = (clip.xy()*invW + Vector2{1.0f})*scale;
+        min = Math::min(min, screen);
+        max = Math::max(max, screen);
+        closest = Math::max(closest, invW);
+    }
+
+    /* All pixels the rectangle touches. Frustum culling already took care
+       of objects outside the viewport. */
+    const Int x0 = Math::max(Int(std::floor(min.x())), 0);
+    const Int y0 = Math::max(Int(std::floor(min.y())), 0);
+    const Int x1 = Math::min(Int(std::floor(max.x())), size.x() - 1);
+    const Int y1 = Math::min(Int(std::floor(max.y())), size.y() - 1);
+    if(x0 > x1 || y0 > y1) return true;
+
+    /* Go up the pyramid until the rectangle covers at most 2x2 texels */
+    std::size_t level = 0;
+    while(level + 1 < _levels.size() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+        ++level;
+
+    const Level& l = _levels[level];
+    const Float* const data = _data.data() + l.offset;
+    Float farthest = Constants::inf();
+    for(Int y = y0 >> level; y <= (y1 >> level); ++y)
+        for(Int x = x0 >> level; x <= (x1 >> level); ++x)
+            farthest = Math::min(farthest, data[std::size_t(y)*l.size.x() + x]);
+
+    return closest >= farthest;
+}
+
+}}
@@ -0,0 +1,119 @@
+#ifndef Magnum_Examples_OcclusionBuffer_h
+#define Magnum_Examples_OcclusionBuffer_h
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vector>
+#include <Corrade/Containers/ArrayView.h>
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Vector2.h>
+
+namespace Magnum { namespace Examples {
+
+/**
+@brief Software hierarchical depth buffer for occlusion culling
+
+A small depth buffer into which a few large occluders are rasterized on the
+CPU every frame, followed by a pyramid of its downsampled levels. Object
+bounds are then tested against the pyramid level where they cover at most two
+texels in each direction, so each test reads at most four values.
+
+Depth is stored as @f$ \frac{1}{w} @f$, which is linear in screen space and
+larger for closer surfaces. The buffer is cleared to @cpp 0.0f @ce and each
+pyramid texel keeps the minimum of the four texels below it, i.e. the
+farthest occluder in its area. The buffer is just an approximation of what
+the GPU draws --- occluder edges are sampled at pixel centers, so an object
+peeking less than half a pixel from behind an occluder edge may get culled.
+*/
+class OcclusionBuffer {
+    public:
+        /**
+         * @brief Constructor
+         *
+         * The buffer covers the whole viewport regardless of its aspect
+         * ratio, so the pixels don't need to be square.
+         */
+        explicit OcclusionBuffer(const Vector2i& size);
+
+        /** @brief Size of the base level */
+        Vector2i size() const { return _levels.front().size; }
+
+        /** @brief Count of pyramid levels including the base */
+        std::size_t levelCount() const { return _levels.size(); }
+
+        /** @brief Size of the base level and the pyramid in bytes */
+        std::size_t dataSize() const { return _data.size()*sizeof(Float); }
+
+        /** @brief Clear the base level */
+        void clear();
+
+        /**
+         * @brief Rasterize occluder triangles
+         * @param transformationProjectionMatrix Occluder transformation
+         *      and projection
+         * @param triangles Triangle positions, three vertices each
+         * @return Count of triangles that got rasterized
+         *
+         * Both windings are rasterized, as occluders are often single-sided
+         * walls. Triangles with a vertex behind the near plane are skipped,
+         * which only makes the culling less aggressive.
+         */
+        std::size_t rasterize(const Matrix4& transformationProjectionMatrix, Containers::ArrayView<const Vector3> triangles);
+
+        /**
+         * @brief Build the pyramid
+         *
+         * Expected to be called after all occluders are rasterized and
+         * before testing objects with @ref isVisible().
+         */
+        void buildPyramid();
+
+        /**
+         * @brief Whether given bounds may be visible
+         *
+         * Returns @cpp false @ce only if the closest corner of @p bounds is
+         * farther than the farthest occluder in the whole screen area the
+         * bounds cover. Bounds crossing the near plane or outside of the
+         * viewport are always reported as visible.
+         */
+        bool isVisible(const Matrix4& transformationProjectionMatrix, const Range3D& bounds) const;
+
+    private:
+        struct Level {
+            Vector2i size;
+            std::size_t offset;
+        };
+
+        std::vector<Level> _levels;
+        std::vector<Float> _data;
+};
+
+}}
+
+#endif
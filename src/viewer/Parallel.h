@@ -0,0 +1,76 @@
+#ifndef Magnum_Examples_Parallel_h
+#define Magnum_Examples_Parallel_h
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <Magnum/Magnum.h>
+
+namespace Magnum { namespace Examples {
+
+/**
+@brief Thread count to use for given value of a command-line option
+
+Zero means "use all cores", anything else is passed through.
+*/
+inline UnsignedInt resolveThreadCount(UnsignedInt count) {
+    if(count) return count;
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+/**
+@brief Execute a job for each index in given range on multiple threads
+
+Calls @p job with the thread ID in range @cpp [0, threadCount) @ce and an
+item index in range @cpp [0, count) @ce. Items are distributed dynamically,
+so a thread that finished a cheap item picks up the next one right away. The
+thread with ID @cpp 0 @ce is the calling thread, which means @p threadCount
+set to @cpp 1 @ce executes everything serially without spawning any threads.
+Returns after all items are processed.
+*/
+template<class Job> void parallelFor(const UnsignedInt threadCount, const std::size_t count, Job&& job) {
+    std::atomic<std::size_t> next{0};
+    auto worker = [&](const UnsignedInt thread) {
+        for(std::size_t i; (i = next++) < count; )
+            job(thread, i);
+    };
+
+    std::vector<std::thread> threads;
+    for(UnsignedInt i = 1; i < threadCount; ++i)
+        threads.emplace_back(worker, i);
+    worker(0);
+    for(std::thread& thread: threads) thread.join();
+}
+
+}}
+
+#endif
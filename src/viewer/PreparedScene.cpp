@@ -0,0 +1,1022 @@
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "PreparedScene.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+#include <sys/stat.h>
+#include <Corrade/Utility/Arguments.h>
+#ifdef CORRADE_TARGET_WINDOWS
+#include <Corrade/Utility/Unicode.h>
+#endif
+#include <Magnum/Mesh.h>
+#include <Magnum/PixelFormat.h>
+#include <Magnum/GL/PixelFormat.h>
+#include <Magnum/Math/Constants.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/MeshTools/CompressIndices.h>
+
+#include "BlockCompression.h"
+#include "Downsample.h"
+#include "Import.h"
+#include "MeshOptimizer.h"
+#include "Parallel.h"
+#include "Trace.h"
+
+namespace Magnum { namespace Examples {
+
+namespace {
+
+constexpr UnsignedInt Version = 9;
+
+std::size_t alignedOffset(const std::size_t offset) {
+    return (offset + 7) & ~std::size_t{7};
+}
+
+std::size_t rowSize(const Int width, const UnsignedInt pixelSize, const UnsignedInt alignment = 4) {
+    return (width*pixelSize + alignment - 1)/alignment*alignment;
+}
+
+/* FNV-1a on 64-bit words. Only used to find candidates for deduplication,
+   which are then compared byte-by-byte, so collisions are not a problem. */
+UnsignedLong hashData(const void* const data, const std::size_t size, UnsignedLong hash = 14695981039346656037ull) {
+    const char* const bytes = static_cast<const char*>(data);
+    std::size_t i = 0;
+    for(; i + 8 <= size; i += 8) {
+        UnsignedLong word;
+        std::memcpy(&word, bytes + i, 8);
+        hash = (hash ^ word)*1099511628211ull;
+    }
+    for(; i != size; ++i)
+        hash = (hash ^ UnsignedByte(bytes[i]))*1099511628211ull;
+    return hash;
+}
+
+/* Size and modification time of a file, false if it doesn't exist. This is
+   all that's needed to check that a prepared scene is up-to-date, reading
+   the sources would defeat the purpose of the cache. */
+bool statFile(const std::string& filename, UnsignedLong& size, Long& modificationTime) {
+    #ifdef CORRADE_TARGET_WINDOWS
+    struct _stat64 info;
+    if(_wstat64(Utility::Unicode::widen(filename).data(), &info) != 0) return false;
+    #else
+    struct stat info;
+    if(stat(filename.data(), &info) != 0) return false;
+    #endif
+    size = info.st_size;
+    modificationTime = info.st_mtime;
+    return true;
+}
+
+/* Relative paths of all files in a directory and its subdirectories up to
+   given depth */
+void listFiles(const std::string& directory, const std::string& prefix, const UnsignedInt depth, std::vector<std::string>& out) {
+    const std::string path = Utility::Directory::join(directory, prefix);
+    for(const std::string& entry: Utility::Directory::list(path, Utility::Directory::Flag::SkipDirectories|Utility::Directory::Flag::SkipSpecial))
+        out.push_back(prefix.empty() ? entry : prefix + '/' + entry);
+    if(depth) for(const std::string& entry: Utility::Directory::list(path, Utility::Directory::Flag::SkipFiles|Utility::Directory::Flag::SkipDotAndDotDot))
+        listFiles(directory, prefix.empty() ? entry : prefix + '/' + entry, depth - 1, out);
+}
+
+bool isNameCharacter(const char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '-' || c == '.' || c == '%' || UnsignedByte(c) >= 0x80;
+}
+
+/* Whether the name ends at given position in the data, with backslashes
+   matching forward slashes, and isn't just a suffix of a longer name */
+bool mentionedAt(const Containers::ArrayView<const char> data, const std::size_t end, const std::string& name) {
+    if(name.size() > end) return false;
+    const std::size_t begin = end - name.size();
+    for(std::size_t i = 0; i != name.size(); ++i)
+        if((data[begin + i] == '\\' ? '/' : data[begin + i]) != name[i]) return false;
+    return !begin || !isNameCharacter(data[begin - 1]);
+}
+
+std::string percentEncoded(const std::string& name) {
+    std::string out;
+    for(const char c: name) {
+        if(c == ' ') out += "%20";
+        else out += c;
+    }
+    return out;
+}
+
+bool equalData(const Containers::Array<char>& a, const Containers::Array<char>& b) {
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size()) == 0;
+}
+
+/* Map each item to the first earlier item that has the same non-zero hash and
+   compares equal to it, or to itself. Returns the count of duplicates. */
+template<class T> std::size_t findDuplicates(const std::vector<T>& items, std::vector<UnsignedInt>& mapping) {
+    std::unordered_multimap<UnsignedLong, UnsignedInt> unique;
+    std::size_t duplicates = 0;
+    mapping.resize(items.size());
+    for(std::size_t i = 0; i != items.size(); ++i) {
+        mapping[i] = i;
+        if(!items[i].hash) continue;
+
+        const auto candidates = unique.equal_range(items[i].hash);
+        for(auto it = candidates.first; it != candidates.second; ++it) {
+            if(!(items[it->second] == items[i])) continue;
+            mapping[i] = it->second;
+            ++duplicates;
+            break;
+        }
+
+        if(mapping[i] == i) unique.emplace(items[i].hash, i);
+    }
+
+    return duplicates;
+}
+
+/* Size of a 4x4 block of supported compressed formats, 0 for unsupported */
+UnsignedInt compressedBlockSize(const CompressedPixelFormat format) {
+    /* BC5, BC7 and ETC2 don't have a generic format yet, so importers give
+       them back as wrapped GL formats */
+    if(isCompressedPixelFormatImplementationSpecific(format)) {
+        switch(compressedPixelFormatUnwrap<GL::CompressedPixelFormat>(format)) {
+            #ifndef MAGNUM_TARGET_GLES
+            case GL::CompressedPixelFormat::RGRgtc2Unorm:
+            case GL::CompressedPixelFormat::RGBABptcUnorm:
+                return 16;
+            #endif
+            case GL::CompressedPixelFormat::RGB8Etc2:
+                return 8;
+            case GL::CompressedPixelFormat::RGBA8Etc2Eac:
+                return 16;
+            default:
+                return 0;
+        }
+    }
+
+    switch(format) {
+        case CompressedPixelFormat::Bc1RGBUnorm:
+        case CompressedPixelFormat::Bc1RGBAUnorm:
+            return 8;
+        case CompressedPixelFormat::Bc3RGBAUnorm:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+struct ConvertedImage {
+    PixelFormat format;
+    /* If set, the format is compressedFormat instead */
+    bool compressed;
+    CompressedPixelFormat compressedFormat;
+    std::vector<Vector2i> sizes;
+    std::vector<Containers::Array<char>> levels;
+    /* Hash of all the above, zero if the conversion failed */
+    UnsignedLong hash;
+};
+
+bool operator==(const ConvertedImage& a, const ConvertedImage& b) {
+    if(a.format != b.format || a.compressed != b.compressed || a.compressedFormat != b.compressedFormat || a.sizes != b.sizes) return false;
+    for(std::size_t i = 0; i != a.levels.size(); ++i)
+        if(!equalData(a.levels[i], b.levels[i])) return false;
+    return true;
+}
+
+std::size_t dataSize(const ConvertedImage& image) {
+    std::size_t size = 0;
+    for(const Containers::Array<char>& level: image.levels)
+        size += level.size();
+    return size;
+}
+
+/* Size of the image in GPU memory, including the mip chain if it gets
+   generated on upload */
+std::size_t gpuSize(const ConvertedImage& image) {
+    const std::size_t size = dataSize(image);
+    return image.levels.size() == 1 && !image.compressed ? size*4/3 : size;
+}
+
+ConvertedImage convertImage(const Trade::ImageData2D& image) {
+    ConvertedImage out{};
+
+    /* Block-compressed images are taken as-is, if the block size is known */
+    if(image.isCompressed()) {
+        const UnsignedInt blockSize = compressedBlockSize(image.compressedFormat());
+        const std::size_t size = blockCompressedSize(image.size(), blockSize);
+        if(!blockSize || image.data().size() < size) return out;
+
+        out.compressed = true;
+        out.compressedFormat = image.compressedFormat();
+        Containers::Array<char> level{Containers::NoInit, size};
+        std::memcpy(level.data(), image.data(), size);
+        out.sizes.push_back(image.size());
+        out.levels.push_back(std::move(level));
+        return out;
+    }
+
+    /* For simplicity only 8-bit-per-channel RGB and RGBA is supported */
+    if(image.format() != PixelFormat::RGB8Unorm && image.format() != PixelFormat::RGBA8Unorm)
+        return out;
+
+    out.format = image.format();
+    const UnsignedInt pixelSize = image.format() == PixelFormat::RGB8Unorm ? 3 : 4;
+
+    /* Copy the base level, normalizing the row alignment */
+    {
+        const char* const src = image.data();
+        const std::size_t srcStride = rowSize(image.size().x(), pixelSize, image.storage().alignment());
+        const std::size_t dstStride = rowSize(image.size().x(), pixelSize);
+        Containers::Array<char> level{Containers::ValueInit, dstStride*image.size().y()};
+        for(Int y = 0; y != image.size().y(); ++y)
+            std::memcpy(level.data() + y*dstStride, src + y*srcStride, image.size().x()*pixelSize);
+
+        out.sizes.push_back(image.size());
+        out.levels.push_back(std::move(level));
+    }
+
+    return out;
+}
+
+/* Rows of a mip level downsampled by a single job. Large images are split
+   into multiple jobs so a scene with a few huge textures still makes use of
+   all threads. */
+constexpr Int MipRowsPerJob = 64;
+
+/* Generate the rest of the mip chains of all uncompressed images, down to
+   1x1. Each level needs the previous one to be complete, so the chains are
+   generated one level at a time, with rows of that level in all images
+   distributed across the threads. */
+void generateMipmaps(std::vector<ConvertedImage>& images, const UnsignedInt threadCount) {
+    struct Job {
+        ConvertedImage* image;
+        Int yBegin, yEnd;
+    };
+    std::vector<Job> jobs;
+    for(std::size_t level = 1; ; ++level) {
+        jobs.clear();
+        for(ConvertedImage& image: images) {
+            if(image.compressed || image.levels.size() != level || image.sizes.back().max() == 1)
+                continue;
+
+            const Vector2i nextSize = Math::max(image.sizes.back()/2, Vector2i{1});
+            const UnsignedInt pixelSize = image.format == PixelFormat::RGB8Unorm ? 3 : 4;
+            image.levels.push_back(Containers::Array<char>{Containers::NoInit, rowSize(nextSize.x(), pixelSize)*nextSize.y()});
+            image.sizes.push_back(nextSize);
+            for(Int y = 0; y < nextSize.y(); y += MipRowsPerJob)
+                jobs.push_back({&image, y, Math::min(y + MipRowsPerJob, nextSize.y())});
+        }
+        if(jobs.empty()) break;
+
+        parallelFor(threadCount, jobs.size(), [&](UnsignedInt, const std::size_t i) {
+            TraceScope traceJob{"prepare", "downsample to level", Long(level)};
+            const Job& job = jobs[i];
+            const ConvertedImage& image = *job.image;
+            downsample(image.levels[level - 1].data(), image.sizes[level - 1], image.levels[level].data(), image.sizes[level], image.format == PixelFormat::RGB8Unorm ? 3 : 4, job.yBegin, job.yEnd);
+        });
+    }
+}
+
+/* Block rows of a level compressed by a single job */
+constexpr Int BlockRowsPerJob = 16;
+
+/* Compress all levels of all uncompressed images into BC1 if RGB and BC3 if
+   RGBA, with block rows of all levels distributed across the threads. Returns
+   count of compressed images. */
+std::size_t compressImages(std::vector<ConvertedImage>& images, const UnsignedInt threadCount) {
+    struct Job {
+        const char* src;
+        Vector2i size;
+        UnsignedInt pixelSize;
+        char* dst;
+        Int blockRowBegin, blockRowEnd;
+    };
+    std::vector<Job> jobs;
+    std::vector<std::vector<Containers::Array<char>>> compressed(images.size());
+    for(std::size_t i = 0; i != images.size(); ++i) {
+        const ConvertedImage& image = images[i];
+        if(image.compressed || image.levels.empty()) continue;
+
+        const UnsignedInt pixelSize = image.format == PixelFormat::RGB8Unorm ? 3 : 4;
+        for(std::size_t j = 0; j != image.levels.size(); ++j) {
+            const Vector2i& size = image.sizes[j];
+            compressed[i].push_back(Containers::Array<char>{Containers::NoInit, blockCompressedSize(size, pixelSize == 3 ? 8 : 16)});
+            const Int blockRowCount = (size.y() + 3)/4;
+            for(Int y = 0; y < blockRowCount; y += BlockRowsPerJob)
+                jobs.push_back({image.levels[j].data(), size, pixelSize, compressed[i].back().data(), y, Math::min(y + BlockRowsPerJob, blockRowCount)});
+        }
+    }
+
+    parallelFor(threadCount, jobs.size(), [&](UnsignedInt, const std::size_t i) {
+        TraceScope traceJob{"prepare", "compress blocks"};
+        const Job& job = jobs[i];
+        compressBlocks(job.src, job.size, job.pixelSize, job.dst, job.blockRowBegin, job.blockRowEnd);
+    });
+
+    std::size_t count = 0;
+    for(std::size_t i = 0; i != images.size(); ++i) {
+        if(compressed[i].empty()) continue;
+        ConvertedImage& image = images[i];
+        image.compressed = true;
+        image.compressedFormat = image.format == PixelFormat::RGB8Unorm ?
+            CompressedPixelFormat::Bc1RGBUnorm : CompressedPixelFormat::Bc3RGBAUnorm;
+        image.levels = std::move(compressed[i]);
+        ++count;
+    }
+
+    return count;
+}
+
+void hashImage(ConvertedImage& image) {
+    if(image.levels.empty()) return;
+    image.hash = hashData(&image.format, sizeof(PixelFormat));
+    image.hash = hashData(&image.compressed, sizeof(bool), image.hash);
+    image.hash = hashData(&image.compressedFormat, sizeof(CompressedPixelFormat), image.hash);
+    image.hash = hashData(image.sizes.data(), image.sizes.size()*sizeof(Vector2i), image.hash);
+    for(const Containers::Array<char>& level: image.levels)
+        image.hash = hashData(level.data(), level.size(), image.hash);
+}
+
+struct CompiledMesh {
+    PreparedMesh mesh{};
+    Containers::Array<char> vertexData, indexData;
+    /* Statistics of the optimization */
+    std::size_t triangleCount, originalVertexDataSize;
+    Float originalCacheMissRatio, cacheMissRatio;
+    /* Hash of the layout and data, zero if the mesh failed to import */
+    UnsignedLong hash;
+};
+
+/* The data offsets in the layout are not filled yet at this point, so they
+   compare equal */
+bool operator==(const CompiledMesh& a, const CompiledMesh& b) {
+    return std::memcmp(&a.mesh, &b.mesh, sizeof(PreparedMesh)) == 0 &&
+        equalData(a.vertexData, b.vertexData) &&
+        equalData(a.indexData, b.indexData);
+}
+
+/* Meshes with fewer triangles than this don't get any LODs */
+constexpr std::size_t MinLodTriangleCount = 512;
+
+/* All attributes the viewer shaders are using */
+struct Geometry {
+    std::vector<Vector3> positions, normals;
+    std::vector<Vector2> textureCoordinates;
+    std::vector<UnsignedInt> indices;
+};
+
+/* Merge each vertex cluster into a single vertex with averaged attributes.
+   Clusters split at seams have a part on each side of the seam, which get
+   the position averaged over the whole cell so the seam doesn't crack, but
+   keep their own texture coordinates and normals. */
+Geometry simplify(const Geometry& in, const std::vector<UnsignedInt>& cells, const UnsignedInt cellCount, const std::vector<UnsignedInt>& clusters, const UnsignedInt clusterCount) {
+    std::vector<Vector3> cellPositions(cellCount);
+    std::vector<UnsignedInt> cellCounts(cellCount);
+    for(std::size_t i = 0; i != cells.size(); ++i) {
+        cellPositions[cells[i]] += in.positions[i];
+        ++cellCounts[cells[i]];
+    }
+
+    Geometry out;
+    out.positions.resize(clusterCount);
+    out.normals.resize(clusterCount);
+    out.textureCoordinates.resize(in.textureCoordinates.empty() ? 0 : clusterCount);
+    std::vector<UnsignedInt> counts(clusterCount);
+    for(std::size_t i = 0; i != clusters.size(); ++i) {
+        const UnsignedInt cluster = clusters[i];
+        out.positions[cluster] = cellPositions[cells[i]]/Float(cellCounts[cells[i]]);
+        out.normals[cluster] += in.normals[i];
+        if(!out.textureCoordinates.empty())
+            out.textureCoordinates[cluster] += in.textureCoordinates[i];
+        ++counts[cluster];
+    }
+
+    /* Normals of opposite faces can cancel each other out */
+    for(std::size_t i = 0; i != clusterCount; ++i) {
+        out.normals[i] = out.normals[i].dot() > 0.0f ? out.normals[i].normalized() : Vector3::zAxis();
+        if(!out.textureCoordinates.empty())
+            out.textureCoordinates[i] /= Float(counts[i]);
+    }
+
+    out.indices = remapTriangles(in.indices, clusters);
+    return out;
+}
+
+CompiledMesh compileMesh(const Trade::MeshData3D& meshData, const PrepareFlags flags) {
+    CompiledMesh out{};
+    out.mesh.primitive = UnsignedInt(meshData.primitive());
+
+    /* Level zero is the original mesh */
+    std::vector<Geometry> levels;
+    levels.reserve(PreparedMesh::MaxLodCount);
+    levels.emplace_back();
+    Geometry& original = levels.front();
+    original.positions = meshData.positions(0);
+    original.normals = meshData.normals(0);
+    if(meshData.hasTextureCoords2D())
+        original.textureCoordinates = meshData.textureCoords2D(0);
+    if(meshData.isIndexed())
+        original.indices = meshData.indices();
+
+    /* Bounds for frustum culling, position quantization and LOD selection */
+    if(!original.positions.empty()) {
+        out.mesh.bounds = {original.positions.front(), original.positions.front()};
+        for(const Vector3& position: original.positions)
+            out.mesh.bounds = {Math::min(out.mesh.bounds.min(), position),
+                               Math::max(out.mesh.bounds.max(), position)};
+    }
+
+    /* Build coarser levels of large indexed triangle meshes by clustering
+       vertices on increasingly coarse grids, each level having at most a
+       quarter of triangles of the previous one. The error is the cell
+       diagonal relative to the bounding sphere radius. */
+    std::vector<Float> errors{0.0f};
+    const Float size = out.mesh.bounds.size().max();
+    const Float radius = out.mesh.bounds.size().length()*0.5f;
+    if(meshData.isIndexed() && meshData.primitive() == MeshPrimitive::Triangles && original.indices.size()/3 >= MinLodTriangleCount && size > 0.0f) {
+        /* Texture coordinates are discontinuous across seams, where the
+           vertices are duplicated. Averaging them across a seam would smear
+           the texture, so clusters of textured meshes are split into parts
+           that are connected through the triangles. */
+        std::vector<UnsignedInt> components, cells(original.positions.size()), clusters;
+        const bool textured = !original.textureCoordinates.empty();
+        if(textured) {
+            components.resize(original.positions.size());
+            clusters.resize(original.positions.size());
+            connectedComponents(original.indices, components);
+        }
+        for(Float cellSize = size/256.0f; levels.size() != PreparedMesh::MaxLodCount && cellSize < size; cellSize *= 2.0f) {
+            const UnsignedInt cellCount = clusterVertices(original.positions, out.mesh.bounds, cellSize, cells);
+            const UnsignedInt clusterCount = textured ? splitClusters(cells, components, clusters) : cellCount;
+            Geometry level = simplify(original, cells, cellCount, textured ? clusters : cells, clusterCount);
+            if(level.indices.empty()) break;
+            if(level.indices.size()*4 > levels.back().indices.size()) continue;
+
+            levels.push_back(std::move(level));
+            errors.push_back(cellSize*Constants::sqrt3()/radius);
+        }
+    }
+
+    /* Reorder indexed triangle meshes for the post-transform vertex cache and
+       then the vertices in order of first use, dropping unused ones. Other
+       meshes keep their original order. All levels share a single vertex and
+       index buffer, with indices of each level offset to its vertices. */
+    std::vector<UnsignedInt> indices;
+    std::vector<std::vector<UnsignedInt>> vertexOrders(levels.size());
+    std::size_t vertexCount = 0;
+    for(std::size_t i = 0; i != levels.size(); ++i) {
+        Geometry& level = levels[i];
+        std::vector<UnsignedInt>& vertexOrder = vertexOrders[i];
+        if(meshData.isIndexed()) {
+            if(meshData.primitive() == MeshPrimitive::Triangles) {
+                if(i == 0) {
+                    out.triangleCount = level.indices.size()/3;
+                    out.originalCacheMissRatio = averageCacheMissRatio(level.indices, level.positions.size());
+                }
+                optimizeVertexCache(level.indices, level.positions.size());
+                if(i == 0)
+                    out.cacheMissRatio = averageCacheMissRatio(level.indices, level.positions.size());
+            }
+
+            std::vector<UnsignedInt> remapping(level.positions.size());
+            vertexOrder.resize(optimizeVertexFetch(level.indices, remapping));
+            for(std::size_t j = 0; j != remapping.size(); ++j)
+                if(remapping[j] != 0xffffffffu) vertexOrder[remapping[j]] = j;
+
+            out.mesh.lods[i] = {UnsignedInt(indices.size()), UnsignedInt(level.indices.size()), errors[i]};
+            for(const UnsignedInt index: level.indices)
+                indices.push_back(index + vertexCount);
+        } else {
+            vertexOrder.resize(level.positions.size());
+            for(std::size_t j = 0; j != vertexOrder.size(); ++j)
+                vertexOrder[j] = j;
+
+            out.mesh.lods[i] = {0, UnsignedInt(level.positions.size()), 0.0f};
+        }
+
+        vertexCount += vertexOrder.size();
+    }
+    out.mesh.lodCount = levels.size();
+    out.mesh.count = out.mesh.lods[0].count;
+
+    /* Interleave the attributes. Quantized positions are padded to four
+       bytes. */
+    const bool quantized = flags & PrepareFlag::QuantizeVertices;
+    const bool textured = !original.textureCoordinates.empty();
+    const std::size_t positionSize = quantized ? 8 : sizeof(Vector3);
+    const std::size_t normalSize = quantized ? 4 : sizeof(Vector3);
+    const std::size_t stride = positionSize + normalSize + (textured ? sizeof(Vector2) : 0);
+    if(quantized) out.mesh.flags |= PreparedMesh::Quantized;
+    if(textured) out.mesh.flags |= PreparedMesh::TextureCoordinates;
+    out.originalVertexDataSize = original.positions.size()*(2*sizeof(Vector3) + (textured ? sizeof(Vector2) : 0));
+    out.vertexData = Containers::Array<char>{Containers::ValueInit, vertexCount*stride};
+    char* vertex = out.vertexData.data();
+    for(std::size_t i = 0; i != levels.size(); ++i) {
+        const Geometry& level = levels[i];
+        for(const UnsignedInt j: vertexOrders[i]) {
+            if(quantized) {
+                const Math::Vector3<UnsignedShort> position = quantizePosition(level.positions[j], out.mesh.bounds);
+                const UnsignedInt normal = packNormal(level.normals[j]);
+                std::memcpy(vertex, &position, sizeof(position));
+                std::memcpy(vertex + positionSize, &normal, sizeof(normal));
+            } else {
+                std::memcpy(vertex, &level.positions[j], sizeof(Vector3));
+                std::memcpy(vertex + positionSize, &level.normals[j], sizeof(Vector3));
+            }
+            if(textured)
+                std::memcpy(vertex + positionSize + normalSize, &level.textureCoordinates[j], sizeof(Vector2));
+            vertex += stride;
+        }
+    }
+
+    /* Compress the indices to the smallest possible type. An indexed mesh
+       with no indices has nothing to draw, it's stored as non-indexed with
+       zero count. */
+    if(meshData.isIndexed() && !indices.empty()) {
+        MeshIndexType indexType;
+        std::tie(out.indexData, indexType, out.mesh.indexStart, out.mesh.indexEnd) = MeshTools::compressIndices(indices);
+        switch(indexType) {
+            case MeshIndexType::UnsignedByte: out.mesh.indexSize = 1; break;
+            case MeshIndexType::UnsignedShort: out.mesh.indexSize = 2; break;
+            case MeshIndexType::UnsignedInt: out.mesh.indexSize = 4; break;
+        }
+    }
+
+    out.hash = hashData(&out.mesh, sizeof(PreparedMesh));
+    out.hash = hashData(out.vertexData.data(), out.vertexData.size(), out.hash);
+    out.hash = hashData(out.indexData.data(), out.indexData.size(), out.hash);
+    return out;
+}
+
+PreparedScene PreparedScene::prepare(const ImportedData& data, const std::vector<SourceFile>& sources, const PrepareFlags flags, const UnsignedInt threadCount) {
+    TraceScope tracePrepare{"prepare", "prepare"};
+    PrepareStatistics statistics{};
+    auto elapsed = [](std::chrono::steady_clock::time_point& start, const char* name) {
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        Tracer::global().add("prepare", name, start, now);
+        const Double duration = std::chrono::duration<double, std::milli>{now - start}.count();
+        start = now;
+        return duration;
+    };
+    std::chrono::steady_clock::time_point stageStart = std::chrono::steady_clock::now();
+
+    /* Convert images and compile meshes in parallel. Each slot is written by
+       exactly one thread, so there's no need for any locking. Meshes are
+       done separately to have the durations of both stages. */
+    std::vector<ConvertedImage> images(data.images.size());
+    std::vector<CompiledMesh> meshes(data.meshes.size());
+    parallelFor(threadCount, images.size(), [&](UnsignedInt, const std::size_t i) {
+        if(!data.images[i]) return;
+        TraceScope traceImage{"prepare", "convert image", Long(i)};
+        images[i] = convertImage(*data.images[i]);
+    });
+    statistics.convertImages = elapsed(stageStart, "convert images");
+    parallelFor(threadCount, meshes.size(), [&](UnsignedInt, const std::size_t i) {
+        if(!data.meshes[i]) return;
+        TraceScope traceMesh{"prepare", "optimize mesh", Long(i)};
+        meshes[i] = compileMesh(*data.meshes[i], flags);
+    });
+    statistics.optimizeMeshes = elapsed(stageStart, "optimize meshes");
+    for(const ConvertedImage& image: images)
+        statistics.imageDataSize += dataSize(image);
+
+    for(std::size_t i = 0; i != images.size(); ++i)
+        if(data.images[i] && images[i].levels.empty())
+            Warning{} << "Image" << i << "has an unsupported format, skipping";
+
+    /* Generate the mip chains on the CPU, if requested, and hash the final
+       data for deduplication */
+    if(flags & PrepareFlag::GenerateMipmaps) {
+        generateMipmaps(images, threadCount);
+        statistics.generateMipmaps = elapsed(stageStart, "generate mipmaps");
+        Debug{} << "Generated mip chains on" << threadCount << "threads in"
+            << statistics.generateMipmaps << "ms";
+    }
+    if(flags & PrepareFlag::CompressTextures) {
+        std::size_t originalSize = 0, compressedSize = 0;
+        for(const ConvertedImage& image: images) originalSize += dataSize(image);
+        const std::size_t count = compressImages(images, threadCount);
+        for(const ConvertedImage& image: images) compressedSize += dataSize(image);
+        statistics.compressTextures = elapsed(stageStart, "compress textures");
+        if(count) Debug{} << "Compressed" << count << "images on" << threadCount << "threads in"
+            << statistics.compressTextures << "ms, texture data"
+            << originalSize/1024 << "->" << compressedSize/1024 << "kB";
+    }
+    parallelFor(threadCount, images.size(), [&](UnsignedInt, const std::size_t i) {
+        hashImage(images[i]);
+    });
+
+    /* Find images and meshes that are byte-for-byte equal to an earlier one.
+       Duplicates are emptied so they don't take any space in the blob and
+       all references are redirected to the first occurence. */
+    std::vector<UnsignedInt> imageMapping, meshMapping;
+    const std::size_t duplicateImageCount = findDuplicates(images, imageMapping);
+    const std::size_t duplicateMeshCount = findDuplicates(meshes, meshMapping);
+    for(std::size_t i = 0; i != images.size(); ++i)
+        if(imageMapping[i] != i) images[i] = ConvertedImage{};
+    UnsignedLong duplicateMeshSize = 0;
+    for(std::size_t i = 0; i != meshes.size(); ++i) if(meshMapping[i] != i) {
+        duplicateMeshSize += meshes[i].vertexData.size() + meshes[i].indexData.size();
+        meshes[i] = CompiledMesh{};
+    }
+
+    /* Textures referencing the same image with the same sampler parameters
+       are duplicates as well. Only those are sharing GPU memory, a duplicate
+       image used with different sampler parameters still gets uploaded
+       twice. */
+    std::vector<PreparedTexture> preparedTextures(data.textures.size());
+    std::vector<UnsignedInt> textureMapping(data.textures.size());
+    std::size_t duplicateTextureCount = 0;
+    UnsignedLong duplicateTextureSize = 0;
+    {
+        std::map<std::tuple<Int, UnsignedInt, UnsignedInt, UnsignedInt, UnsignedInt, UnsignedInt>, UnsignedInt> unique;
+        for(std::size_t i = 0; i != data.textures.size(); ++i) {
+            textureMapping[i] = i;
+            PreparedTexture& texture = preparedTextures[i];
+            const Containers::Optional<Trade::TextureData>& textureData = data.textures[i];
+            if(!textureData) {
+                texture.image = -1;
+                continue;
+            }
+
+            texture.image = imageMapping[textureData->image()];
+            texture.minificationFilter = UnsignedInt(textureData->minificationFilter());
+            texture.magnificationFilter = UnsignedInt(textureData->magnificationFilter());
+            texture.mipmapFilter = UnsignedInt(textureData->mipmapFilter());
+            texture.wrapping[0] = UnsignedInt(textureData->wrapping().x());
+            texture.wrapping[1] = UnsignedInt(textureData->wrapping().y());
+            if(images[texture.image].levels.empty()) continue;
+
+            const auto inserted = unique.emplace(std::make_tuple(texture.image,
+                texture.minificationFilter, texture.magnificationFilter,
+                texture.mipmapFilter, texture.wrapping[0], texture.wrapping[1]), i);
+            if(inserted.second) continue;
+
+            textureMapping[i] = inserted.first->second;
+            duplicateTextureSize += gpuSize(images[texture.image]);
+            ++duplicateTextureCount;
+            texture.image = -1;
+        }
+    }
+
+    statistics.deduplicate = elapsed(stageStart, "deduplicate");
+    if(duplicateImageCount || duplicateTextureCount || duplicateMeshCount)
+        Debug{} << "Found" << duplicateImageCount << "duplicate images,"
+            << duplicateTextureCount << "duplicate textures and"
+            << duplicateMeshCount << "duplicate meshes";
+
+    /* Summarize the effect of mesh optimization, with the cache miss ratio
+       weighted by triangle count */
+    {
+        std::size_t triangleCount = 0, originalVertexDataSize = 0, vertexDataSize = 0, lodCount = 0, lodMeshCount = 0;
+        Double originalCacheMisses = 0.0, cacheMisses = 0.0;
+        for(const CompiledMesh& mesh: meshes) {
+            triangleCount += mesh.triangleCount;
+            originalVertexDataSize += mesh.originalVertexDataSize;
+            vertexDataSize += mesh.vertexData.size();
+            if(mesh.mesh.lodCount > 1) {
+                lodCount += mesh.mesh.lodCount - 1;
+                ++lodMeshCount;
+            }
+            originalCacheMisses += Double(mesh.originalCacheMissRatio)*mesh.triangleCount;
+            cacheMisses += Double(mesh.cacheMissRatio)*mesh.triangleCount;
+        }
+        if(triangleCount) Debug{} << "Optimized meshes, average cache miss ratio"
+            << originalCacheMisses/triangleCount << "->" << cacheMisses/triangleCount;
+        if(lodMeshCount) Debug{} << "Generated" << lodCount << "LOD levels for" << lodMeshCount << "meshes";
+        if(originalVertexDataSize) Debug{} << "Vertex data"
+            << originalVertexDataSize/1024 << "->" << vertexDataSize/1024 << "kB";
+        statistics.originalVertexDataSize = originalVertexDataSize;
+        statistics.vertexDataSize = vertexDataSize;
+    }
+    for(const ConvertedImage& image: images)
+        statistics.textureDataSize += dataSize(image);
+    for(const CompiledMesh& mesh: meshes)
+        statistics.indexDataSize += mesh.indexData.size();
+    stageStart = std::chrono::steady_clock::now();
+
+    /* Calculate the layout. Header and arrays first, data after. */
+    PreparedHeader header{};
+    std::memcpy(header.magic, "MVSC", 4);
+    header.version = Version;
+    header.sourceCount = sources.size();
+    header.flags = UnsignedInt(flags);
+    header.duplicateImageCount = duplicateImageCount;
+    header.duplicateTextureCount = duplicateTextureCount;
+    header.duplicateMeshCount = duplicateMeshCount;
+    header.duplicateTextureSize = duplicateTextureSize;
+    header.duplicateMeshSize = duplicateMeshSize;
+    header.textureCount = data.textures.size();
+    header.imageCount = images.size();
+    header.materialCount = data.materials.size();
+    header.meshCount = meshes.size();
+    header.objectCount = data.objects.size();
+    for(const ConvertedImage& image: images)
+        header.levelCount += image.levels.size();
+
+    std::size_t offset = alignedOffset(sizeof(PreparedHeader));
+    header.sourceOffset = offset;
+    offset = alignedOffset(offset + header.sourceCount*sizeof(PreparedSource));
+    header.textureOffset = offset;
+    offset = alignedOffset(offset + header.textureCount*sizeof(PreparedTexture));
+    header.imageOffset = offset;
+    offset = alignedOffset(offset + header.imageCount*sizeof(PreparedImage));
+    header.levelOffset = offset;
+    offset = alignedOffset(offset + header.levelCount*sizeof(PreparedLevel));
+    header.materialOffset = offset;
+    offset = alignedOffset(offset + header.materialCount*sizeof(PreparedMaterial));
+    header.meshOffset = offset;
+    offset = alignedOffset(offset + header.meshCount*sizeof(PreparedMesh));
+    header.objectOffset = offset;
+    offset = alignedOffset(offset + header.objectCount*sizeof(PreparedObject));
+
+    std::vector<PreparedSource> preparedSources;
+    preparedSources.reserve(sources.size());
+    for(const SourceFile& source: sources) {
+        preparedSources.push_back({source.size, source.modificationTime, offset, source.name.size()});
+        offset += source.name.size();
+    }
+    offset = alignedOffset(offset);
+
+    std::vector<PreparedLevel> levels;
+    levels.reserve(header.levelCount);
+    for(const ConvertedImage& image: images) for(std::size_t i = 0; i != image.levels.size(); ++i) {
+        levels.push_back({image.sizes[i], offset, image.levels[i].size()});
+        offset = alignedOffset(offset + image.levels[i].size());
+    }
+    for(CompiledMesh& mesh: meshes) {
+        mesh.mesh.vertexDataOffset = offset;
+        mesh.mesh.vertexDataSize = mesh.vertexData.size();
+        offset = alignedOffset(offset + mesh.vertexData.size());
+        mesh.mesh.indexDataOffset = offset;
+        mesh.mesh.indexDataSize = mesh.indexData.size();
+        offset = alignedOffset(offset + mesh.indexData.size());
+    }
+
+    /* Fill the blob */
+    PreparedScene out;
+    out._data = Containers::Array<char>{Containers::ValueInit, offset};
+    out._view = out._data;
+    char* const blob = out._data.data();
+    *reinterpret_cast<PreparedHeader*>(blob) = header;
+
+    std::copy(preparedSources.begin(), preparedSources.end(), reinterpret_cast<PreparedSource*>(blob + header.sourceOffset));
+    for(std::size_t i = 0; i != sources.size(); ++i)
+        std::memcpy(blob + preparedSources[i].nameOffset, sources[i].name.data(), sources[i].name.size());
+
+    std::copy(preparedTextures.begin(), preparedTextures.end(), reinterpret_cast<PreparedTexture*>(blob + header.textureOffset));
+
+    auto* const preparedImages = reinterpret_cast<PreparedImage*>(blob + header.imageOffset);
+    for(std::size_t i = 0, levelOffset = 0; i != images.size(); ++i) {
+        const ConvertedImage& image = images[i];
+        if(image.compressed) {
+            preparedImages[i].format = UnsignedInt(image.compressedFormat);
+            preparedImages[i].flags = PreparedImage::Compressed;
+            preparedImages[i].size = image.sizes[0];
+        } else if(!image.levels.empty()) {
+            preparedImages[i].format = UnsignedInt(image.format);
+            preparedImages[i].size = image.sizes[0];
+        }
+        preparedImages[i].levelCount = image.levels.size();
+        preparedImages[i].levelOffset = levelOffset;
+
+        for(std::size_t j = 0; j != image.levels.size(); ++j)
+            std::memcpy(blob + levels[levelOffset + j].dataOffset, image.levels[j].data(), image.levels[j].size());
+        levelOffset += image.levels.size();
+    }
+    std::copy(levels.begin(), levels.end(), reinterpret_cast<PreparedLevel*>(blob + header.levelOffset));
+
+    /* Failed materials are white, textured materials have white as a
+       fallback for when the texture fails to load */
+    auto* const materials = reinterpret_cast<PreparedMaterial*>(blob + header.materialOffset);
+    for(std::size_t i = 0; i != data.materials.size(); ++i) {
+        const Containers::Optional<Trade::PhongMaterialData>& material = data.materials[i];
+        if(material && (material->flags() & Trade::PhongMaterialData::Flag::DiffuseTexture))
+            materials[i] = {Color4{1.0f}, Int(textureMapping[material->diffuseTexture()])};
+        else if(material)
+            materials[i] = {material->diffuseColor(), -1};
+        else
+            materials[i] = {Color4{1.0f}, -1};
+    }
+
+    auto* const preparedMeshes = reinterpret_cast<PreparedMesh*>(blob + header.meshOffset);
+    for(std::size_t i = 0; i != meshes.size(); ++i) {
+        const CompiledMesh& mesh = meshes[i];
+        preparedMeshes[i] = mesh.mesh;
+        std::memcpy(blob + mesh.mesh.vertexDataOffset, mesh.vertexData.data(), mesh.vertexData.size());
+        std::memcpy(blob + mesh.mesh.indexDataOffset, mesh.indexData.data(), mesh.indexData.size());
+    }
+
+    auto* const objects = reinterpret_cast<PreparedObject*>(blob + header.objectOffset);
+    for(std::size_t i = 0; i != data.objects.size(); ++i) {
+        const ImportedObject& object = data.objects[i];
+        objects[i] = {object.transformation, object.parent,
+            object.mesh == -1 ? -1 : Int(meshMapping[object.mesh]), object.material,
+            object.occluder ? UnsignedInt(PreparedObject::Occluder) : 0};
+    }
+
+    statistics.layout = elapsed(stageStart, "layout");
+    out._statistics = statistics;
+    return out;
+}
+
+Containers::Optional<PreparedScene> PreparedScene::open(const std::string& filename, const std::string& sourceFile, const PrepareFlags flags) {
+    if(!Utility::Directory::exists(filename)) return Containers::NullOpt;
+
+    PreparedScene out;
+    #if defined(CORRADE_TARGET_UNIX) || (defined(CORRADE_TARGET_WINDOWS) && !defined(CORRADE_TARGET_WINDOWS_RT))
+    out._mapped = Utility::Directory::mapRead(filename);
+    out._view = {out._mapped.data(), out._mapped.size()};
+    #else
+    out._data = Utility::Directory::read(filename);
+    out._view = out._data;
+    #endif
+
+    if(out._view.size() < sizeof(PreparedHeader) || std::memcmp(out.header().magic, "MVSC", 4) != 0 || out.header().version != Version) {
+        Warning{} << "Ignoring invalid prepared scene" << filename;
+        return Containers::NullOpt;
+    }
+
+    const PreparedHeader& header = out.header();
+    if(header.flags != UnsignedInt(flags)) {
+        Warning{} << "Ignoring stale prepared scene" << filename;
+        return Containers::NullOpt;
+    }
+
+    /* Verify that everything is inside the file so we don't need to check
+       anything during upload. Indices are either -1 or point to an existing
+       item. */
+    const UnsignedLong size = out._view.size();
+    auto inRange = [size](const UnsignedLong offset, const UnsignedLong count) {
+        return offset <= size && count <= size - offset;
+    };
+    bool valid =
+        header.sourceCount &&
+        inRange(header.sourceOffset, UnsignedLong(header.sourceCount)*sizeof(PreparedSource)) &&
+        inRange(header.textureOffset, UnsignedLong(header.textureCount)*sizeof(PreparedTexture)) &&
+        inRange(header.imageOffset, UnsignedLong(header.imageCount)*sizeof(PreparedImage)) &&
+        inRange(header.levelOffset, UnsignedLong(header.levelCount)*sizeof(PreparedLevel)) &&
+        inRange(header.materialOffset, UnsignedLong(header.materialCount)*sizeof(PreparedMaterial)) &&
+        inRange(header.meshOffset, UnsignedLong(header.meshCount)*sizeof(PreparedMesh)) &&
+        inRange(header.objectOffset, UnsignedLong(header.objectCount)*sizeof(PreparedObject));
+    if(valid) for(const PreparedSource& source: out.sources())
+        valid = valid && inRange(source.nameOffset, source.nameSize);
+    if(valid) for(const PreparedTexture& texture: out.textures())
+        valid = valid && texture.image >= -1 && texture.image < Int(header.imageCount);
+    if(valid) for(std::size_t i = 0; i != header.materialCount; ++i)
+        valid = valid && out.materials()[i].diffuseTexture >= -1 && out.materials()[i].diffuseTexture < Int(header.textureCount);
+    if(valid) for(std::size_t i = 0; i != header.objectCount; ++i) {
+        const PreparedObject& object = out.objects()[i];
+        valid = valid &&
+            object.parent >= -1 && object.parent < Int(i) &&
+            object.mesh >= -1 && object.mesh < Int(header.meshCount) &&
+            object.material >= -1 && object.material < Int(header.materialCount);
+    }
+    if(valid) for(const PreparedImage& image: out.images())
+        valid = valid && UnsignedLong(image.levelOffset) + image.levelCount <= header.levelCount;
+    if(valid) for(const PreparedLevel& level: out.levels())
+        valid = valid && inRange(level.dataOffset, level.dataSize);
+    if(valid) for(const PreparedMesh& mesh: out.meshes()) {
+        valid = valid && inRange(mesh.vertexDataOffset, mesh.vertexDataSize) && inRange(mesh.indexDataOffset, mesh.indexDataSize) && mesh.lodCount <= PreparedMesh::MaxLodCount && (mesh.lodCount || !mesh.count);
+        /* Indexed meshes have all levels in the index data and the indices
+           in the vertex data, non-indexed are just the vertex data */
+        const UnsignedLong stride = vertexStride(mesh);
+        if(valid && mesh.indexSize) {
+            for(std::size_t i = 0; i != mesh.lodCount; ++i)
+                valid = valid && (UnsignedLong(mesh.lods[i].indexOffset) + mesh.lods[i].count)*mesh.indexSize <= mesh.indexDataSize;
+            valid = valid && (!mesh.count || (UnsignedLong(mesh.indexEnd) + 1)*stride <= mesh.vertexDataSize);
+        } else if(valid) for(std::size_t i = 0; i != mesh.lodCount; ++i)
+            valid = valid && UnsignedLong(mesh.lods[i].count)*stride <= mesh.vertexDataSize;
+    }
+    if(!valid) {
+        Warning{} << "Ignoring corrupted prepared scene" << filename;
+        return Containers::NullOpt;
+    }
+
+    /* The scene file itself is recorded first. If it or any of the external
+       files changed, the scene needs to be prepared again. */
+    const std::string directory = Utility::Directory::path(sourceFile);
+    bool stale = out.name(out.sources()[0]) != Utility::Directory::filename(sourceFile);
+    for(const PreparedSource& source: out.sources()) {
+        if(stale) break;
+        UnsignedLong size;
+        Long modificationTime;
+        stale = !statFile(Utility::Directory::join(directory, out.name(source)), size, modificationTime) || size != source.size || modificationTime != source.modificationTime;
+    }
+    if(stale) {
+        Warning{} << "Ignoring stale prepared scene" << filename;
+        return Containers::NullOpt;
+    }
+
+    return Containers::Optional<PreparedScene>{std::move(out)};
+}
+
+bool PreparedScene::save(const std::string& filename) const {
+    return Utility::Directory::write(filename, _view);
+}
+
+void addPrepareArguments(Utility::Arguments& args) {
+    args.addBooleanOption("quantize").setHelp("quantize", "quantize vertex positions to 16 and normals to 10 bits per component")
+        .addBooleanOption("compress").setHelp("compress", "compress RGB textures to BC1 and RGBA textures to BC3");
+}
+
+PrepareFlags prepareFlagsFromArguments(const Utility::Arguments& args) {
+    /* Always generate the whole mip chains on the CPU and upload them
+       explicitly. GL::Texture2D::generateMipmap() is extremely slow on
+       software rasterizers, it would have to be done again on every start
+       while the CPU chains get saved to the cache, streaming the textures
+       needs the small levels first and compressed textures can't have the
+       chains generated on the GPU at all. */
+    PrepareFlags flags = PrepareFlag::GenerateMipmaps;
+    if(args.isSet("quantize")) flags |= PrepareFlag::QuantizeVertices;
+    if(args.isSet("compress")) flags |= PrepareFlag::CompressTextures;
+    return flags;
+}
+
+std::size_t vertexStride(const PreparedMesh& mesh) {
+    return (mesh.flags & PreparedMesh::Quantized ? 8 + 4 : 2*sizeof(Vector3)) +
+        (mesh.flags & PreparedMesh::TextureCoordinates ? sizeof(Vector2) : 0);
+}
+
+std::vector<SourceFile> sourceFiles(const std::string& file) {
+    std::vector<SourceFile> out;
+    const std::string directory = Utility::Directory::path(file);
+    out.push_back({Utility::Directory::filename(file), 0, 0});
+
+    /* Candidates are grouped by extension, so the data can be scanned just
+       for extensions and then the names compared only for the few files that
+       have it. Other prepared scenes are never referenced. */
+    std::vector<std::string> candidates;
+    listFiles(directory, {}, 3, candidates);
+    std::unordered_multimap<std::string, std::size_t> extensions;
+    for(std::size_t i = 0; i != candidates.size(); ++i) {
+        const std::size_t dot = candidates[i].rfind('.');
+        if(candidates[i] == out.front().name || dot == std::string::npos) continue;
+        std::string extension = candidates[i].substr(dot + 1);
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) {
+            return char(std::tolower(static_cast<unsigned char>(c)));
+        });
+        if(extension != "cache") extensions.emplace(extension, i);
+    }
+    std::vector<bool> found(candidates.size());
+
+    /* Scan the scene file and then each file found in it. Names in glTF are
+       URIs, so spaces may be percent-encoded. */
+    for(std::size_t scanned = 0; scanned != out.size(); ++scanned) {
+        const Containers::Array<char> data = Utility::Directory::read(Utility::Directory::join(directory, out[scanned].name));
+        for(std::size_t i = 0; i != data.size(); ++i) {
+            if(data[i] != '.') continue;
+
+            std::string extension;
+            std::size_t end = i + 1;
+            for(; end != data.size() && end - i <= 8 && std::isalnum(static_cast<unsigned char>(data[end])); ++end)
+                extension += char(std::tolower(static_cast<unsigned char>(data[end])));
+            if(extension.empty() || (end != data.size() && isNameCharacter(data[end]) && data[end] != '.'))
+                continue;
+
+            const auto matching = extensions.equal_range(extension);
+            for(auto it = matching.first; it != matching.second; ++it) {
+                if(found[it->second]) continue;
+                const std::string& name = candidates[it->second];
+                if(!mentionedAt(data, end, name) && !mentionedAt(data, end, percentEncoded(name)))
+                    continue;
+                found[it->second] = true;
+                out.push_back({name, 0, 0});
+            }
+        }
+    }
+
+    for(SourceFile& source: out)
+        statFile(Utility::Directory::join(directory, source.name), source.size, source.modificationTime);
+    return out;
+}
+
+}}
@@ -0,0 +1,394 @@
+#ifndef Magnum_Examples_PreparedScene_h
+#define Magnum_Examples_PreparedScene_h
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <string>
+#include <vector>
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/EnumSet.h>
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Utility/Directory.h>
+#include <Corrade/Utility/Utility.h>
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Color.h>
+#include <Magnum/Math/Matrix4.h>
+#include <Magnum/Math/Range.h>
+
+namespace Magnum { namespace Examples {
+
+struct ImportedData;
+
+/*
+A prepared scene is a single contiguous blob with everything the viewer needs
+to populate the scene, already in a form that can be uploaded to the GPU as-is.
+The structures below are stored in the blob directly, consisting only of
+fixed-size types, and all offsets are relative to the blob start. The blob can
+be saved to a file and memory-mapped on next start, skipping the importer
+completely.
+*/
+
+/** @brief Prepared scene header */
+struct PreparedHeader {
+    char magic[4];              /**< Always `MVSC` */
+    UnsignedInt version;        /**< Format version */
+    UnsignedInt sourceCount;    /**< Count of source files */
+    UnsignedInt textureCount, imageCount, levelCount, materialCount,
+        meshCount, objectCount;
+    UnsignedInt flags;          /**< @ref PrepareFlags used */
+    /** Count of images, textures and meshes deduplicated by @ref PreparedScene::prepare() */
+    UnsignedInt duplicateImageCount, duplicateTextureCount, duplicateMeshCount;
+    /** GPU memory not allocated thanks to deduplicated textures and meshes */
+    UnsignedLong duplicateTextureSize, duplicateMeshSize;
+    UnsignedLong sourceOffset, textureOffset, imageOffset, levelOffset, materialOffset,
+        meshOffset, objectOffset;
+};
+
+/**
+@brief Source file of a prepared scene
+
+The scene file itself comes first, followed by external files it references.
+The name is relative to the directory of the scene file, not null-terminated.
+*/
+struct PreparedSource {
+    UnsignedLong size;          /**< File size */
+    Long modificationTime;      /**< Modification time in seconds */
+    UnsignedLong nameOffset, nameSize;
+};
+
+/** @brief Prepared texture */
+struct PreparedTexture {
+    Int image;                  /**< Image index or @cpp -1 @ce */
+    UnsignedInt minificationFilter; /**< @ref SamplerFilter */
+    UnsignedInt magnificationFilter; /**< @ref SamplerFilter */
+    UnsignedInt mipmapFilter;   /**< @ref SamplerMipmap */
+    UnsignedInt wrapping[2];    /**< @ref SamplerWrapping in X and Y */
+};
+
+/**
+@brief Prepared image
+
+Image with @ref levelCount set to @cpp 0 @ce failed to import. Uncompressed
+images have the whole mip chain if prepared with
+@ref PrepareFlag::GenerateMipmaps, which the viewer always uses, and just the
+base level otherwise.
+*/
+struct PreparedImage {
+    enum: UnsignedInt {
+        Compressed = 1 << 0
+    };
+
+    /** @ref CompressedPixelFormat if @ref Compressed is set, @ref PixelFormat otherwise */
+    UnsignedInt format;
+    UnsignedInt flags;
+    Vector2i size;
+    UnsignedInt levelCount;     /**< Count of mip levels */
+    UnsignedInt levelOffset;    /**< Index of the first level */
+};
+
+/**
+@brief Prepared image mip level
+
+Pixel data are with the default four-byte row alignment, compressed data
+have the blocks tightly packed.
+*/
+struct PreparedLevel {
+    Vector2i size;
+    UnsignedLong dataOffset, dataSize;
+};
+
+/**
+@brief Prepared material
+
+Materials that failed to import are white with no texture.
+*/
+struct PreparedMaterial {
+    Color4 diffuseColor;
+    Int diffuseTexture;         /**< Texture index or @cpp -1 @ce */
+};
+
+/**
+@brief Prepared mesh level of detail
+
+The @ref error is the maximal distance of the simplified surface from the
+original relative to the bounding sphere radius, @cpp 0.0f @ce for the
+original mesh.
+*/
+struct PreparedLod {
+    UnsignedInt indexOffset;    /**< Offset of the first index */
+    UnsignedInt count;          /**< Index or vertex count */
+    Float error;
+};
+
+/**
+@brief Prepared mesh
+
+Vertex data have interleaved positions, normals and optionally texture
+coordinates, indices are ordered for the post-transform vertex cache and
+vertices in order of their first use. If @ref Quantized is set, positions are
+16-bit unsigned normalized with two bytes of padding, dequantized by
+translating to @cpp bounds.min() @ce and scaling by @cpp bounds.size() @ce, and
+normals are packed in a signed normalized 10-10-10-2 format. Meshes with
+@ref count set to @cpp 0 @ce failed to import.
+
+Large indexed triangle meshes have additional simplified levels of detail
+stored after the original in the same vertex and index data, with indices
+already offset to vertices of given level. The @ref count is for the original
+mesh, while @ref indexStart and @ref indexEnd cover all levels.
+*/
+struct PreparedMesh {
+    enum: UnsignedInt {
+        TextureCoordinates = 1 << 0,
+        Quantized = 1 << 1
+    };
+
+    enum: UnsignedInt {
+        MaxLodCount = 5         /**< Max count of levels of detail */
+    };
+
+    UnsignedInt primitive;      /**< @ref MeshPrimitive */
+    UnsignedInt flags;          /**< Presence of optional attributes */
+    UnsignedInt count;          /**< Index or vertex count */
+    UnsignedInt indexSize;      /**< Index type size or @cpp 0 @ce */
+    UnsignedInt indexStart, indexEnd;
+    UnsignedLong vertexDataOffset, vertexDataSize,
+        indexDataOffset, indexDataSize;
+    Range3D bounds;             /**< Bounds of vertex positions */
+    UnsignedInt lodCount;       /**< Count of levels of detail, at least 1 */
+    PreparedLod lods[MaxLodCount];
+};
+
+/**
+@brief Prepared object
+
+Parent index is always lower than index of the object itself. If
+@ref Occluder is set, the object was designated as an occluder for occlusion
+culling.
+*/
+struct PreparedObject {
+    enum: UnsignedInt {
+        Occluder = 1 << 0
+    };
+
+    Matrix4 transformation;
+    Int parent;                 /**< Parent index or @cpp -1 @ce */
+    Int mesh;                   /**< Mesh index or @cpp -1 @ce */
+    Int material;               /**< Material index or @cpp -1 @ce */
+    UnsignedInt flags;
+};
+
+/** @brief Source file of a scene, with the name relative to the scene file */
+struct SourceFile {
+    std::string name;
+    UnsignedLong size;
+    Long modificationTime;
+};
+
+/** @brief Scene preparation flag */
+enum class PrepareFlag: UnsignedInt {
+    /**
+     * Generate full mip chains on the CPU. Otherwise only the base level is
+     * stored and the chain is generated on upload.
+     */
+    GenerateMipmaps = 1 << 0,
+
+    /**
+     * Quantize vertex positions to 16 bits and normals to 10 bits per
+     * component
+     */
+    QuantizeVertices = 1 << 1,
+
+    /**
+     * Compress RGB images to BC1 and RGBA images to BC3, including the whole
+     * mip chain if generated. Images that are already compressed are kept
+     * as they are.
+     */
+    CompressTextures = 1 << 2
+};
+
+typedef Containers::EnumSet<PrepareFlag> PrepareFlags;
+
+CORRADE_ENUMSET_OPERATORS(PrepareFlags)
+
+/**
+@brief Statistics of the scene preparation
+
+Durations of the stages of @ref PreparedScene::prepare() in milliseconds and
+data sizes before and after them in bytes.
+*/
+struct PrepareStatistics {
+    Double convertImages;       /**< Converting images to supported formats */
+    Double optimizeMeshes;      /**< Compiling, optimizing and simplifying meshes */
+    Double generateMipmaps;     /**< Generating mip chains */
+    Double compressTextures;    /**< Block compression */
+    Double deduplicate;         /**< Hashing and finding duplicates */
+    Double layout;              /**< Filling the blob */
+    UnsignedLong imageDataSize; /**< Converted images, base levels only */
+    UnsignedLong textureDataSize; /**< Final texture data without duplicates */
+    UnsignedLong originalVertexDataSize; /**< Vertex data of imported meshes */
+    UnsignedLong vertexDataSize; /**< Final vertex data without duplicates */
+    UnsignedLong indexDataSize; /**< Final index data without duplicates */
+};
+
+/** @brief Scene prepared for upload */
+class PreparedScene {
+    public:
+        /**
+         * @brief Prepare imported data
+         *
+         * Converts images and compiles and optimizes meshes on
+         * @p threadCount threads. Images, textures and meshes that are
+         * equal to an earlier one are stored just once and all references
+         * point to the first occurence. The @p sources, usually returned by
+         * @ref sourceFiles(), are saved in the header to detect stale files.
+         */
+        static PreparedScene prepare(const ImportedData& data, const std::vector<SourceFile>& sources, PrepareFlags flags, UnsignedInt threadCount);
+
+        /**
+         * @brief Memory-map a previously saved scene
+         *
+         * Returns @ref Containers::NullOpt if the file doesn't exist, is not
+         * valid or was created with different @p flags. Also if any of the
+         * recorded source files, relative to the directory of @p sourceFile,
+         * is missing or has a different size or modification time. The
+         * sources are only checked with @cpp stat() @ce, not read.
+         */
+        static Containers::Optional<PreparedScene> open(const std::string& filename, const std::string& sourceFile, PrepareFlags flags);
+
+        /** @brief Save the scene into a file */
+        bool save(const std::string& filename) const;
+
+        /**
+         * @brief Statistics of the preparation
+         *
+         * All zeros for scenes loaded with @ref open().
+         */
+        const PrepareStatistics& statistics() const { return _statistics; }
+
+        /** @brief Size of the whole blob in bytes */
+        std::size_t size() const { return _view.size(); }
+
+        const PreparedHeader& header() const {
+            return *reinterpret_cast<const PreparedHeader*>(_view.data());
+        }
+
+        Containers::ArrayView<const PreparedSource> sources() const {
+            return {reinterpret_cast<const PreparedSource*>(_view.data() + header().sourceOffset), header().sourceCount};
+        }
+
+        /** @brief Name of given source file */
+        std::string name(const PreparedSource& source) const {
+            return {_view.data() + source.nameOffset, std::size_t(source.nameSize)};
+        }
+
+        Containers::ArrayView<const PreparedTexture> textures() const {
+            return {reinterpret_cast<const PreparedTexture*>(_view.data() + header().textureOffset), header().textureCount};
+        }
+
+        Containers::ArrayView<const PreparedImage> images() const {
+            return {reinterpret_cast<const PreparedImage*>(_view.data() + header().imageOffset), header().imageCount};
+        }
+
+        Containers::ArrayView<const PreparedLevel> levels() const {
+            return {reinterpret_cast<const PreparedLevel*>(_view.data() + header().levelOffset), header().levelCount};
+        }
+
+        Containers::ArrayView<const PreparedMaterial> materials() const {
+            return {reinterpret_cast<const PreparedMaterial*>(_view.data() + header().materialOffset), header().materialCount};
+        }
+
+        Containers::ArrayView<const PreparedMesh> meshes() const {
+            return {reinterpret_cast<const PreparedMesh*>(_view.data() + header().meshOffset), header().meshCount};
+        }
+
+        Containers::ArrayView<const PreparedObject> objects() const {
+            return {reinterpret_cast<const PreparedObject*>(_view.data() + header().objectOffset), header().objectCount};
+        }
+
+        /** @brief Levels of given image */
+        Containers::ArrayView<const PreparedLevel> levels(const PreparedImage& image) const {
+            return levels().slice(image.levelOffset, image.levelOffset + image.levelCount);
+        }
+
+        /** @brief Data of given image level */
+        Containers::ArrayView<const char> data(const PreparedLevel& level) const {
+            return _view.slice(level.dataOffset, level.dataOffset + level.dataSize);
+        }
+
+        /** @brief Vertex data of given mesh */
+        Containers::ArrayView<const char> vertexData(const PreparedMesh& mesh) const {
+            return _view.slice(mesh.vertexDataOffset, mesh.vertexDataOffset + mesh.vertexDataSize);
+        }
+
+        /** @brief Index data of given mesh */
+        Containers::ArrayView<const char> indexData(const PreparedMesh& mesh) const {
+            return _view.slice(mesh.indexDataOffset, mesh.indexDataOffset + mesh.indexDataSize);
+        }
+
+    private:
+        explicit PreparedScene() = default;
+
+        Containers::Array<char> _data;
+        #if defined(CORRADE_TARGET_UNIX) || (defined(CORRADE_TARGET_WINDOWS) && !defined(CORRADE_TARGET_WINDOWS_RT))
+        Containers::Array<const char, Utility::Directory::MapDeleter> _mapped;
+        #endif
+        Containers::ArrayView<const char> _view;
+        PrepareStatistics _statistics{};
+};
+
+/** @brief Add command-line options controlling @ref PrepareFlags */
+void addPrepareArguments(Utility::Arguments& args);
+
+/**
+@brief Prepare flags from parsed command-line options
+
+Expects that @p args were set up with @ref addPrepareArguments(). Always
+includes @ref PrepareFlag::GenerateMipmaps.
+*/
+PrepareFlags prepareFlagsFromArguments(const Utility::Arguments& args);
+
+/** @brief Size of a vertex of given mesh in bytes */
+std::size_t vertexStride(const PreparedMesh& mesh);
+
+/**
+@brief Files a scene is made from
+
+The scene file itself and all files in its directory and subdirectories
+whose relative path appears in it or, recursively, in another file found this
+way, such as external buffers and images of glTF files or material libraries
+of OBJ files and the textures referenced from those. The importer plugins
+don't report which files they open, so this is a conservative approximation
+done once when the scene is prepared. Files that can't be found have the size
+and modification time @cpp 0 @ce.
+*/
+std::vector<SourceFile> sourceFiles(const std::string& file);
+
+}}
+
+#endif
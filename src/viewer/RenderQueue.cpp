@@ -0,0 +1,115 @@
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <Corrade/Utility/Assert.h>
+
+#include "InstancedDrawable.h"
+
+namespace Magnum { namespace Examples {
+
+namespace {
+
+enum: UnsignedInt {
+    ProgramShift = 48,
+    TextureShift = 24,
+    MeshMask = (1 << 24) - 1,
+    TextureMask = (1 << 24) - 1
+};
+
+/* Count which parts of the state differ between two consecutive keys */
+void countChanges(const UnsignedLong previous, const UnsignedLong current, UnsignedInt& programChanges, UnsignedInt& textureChanges, UnsignedInt& meshChanges) {
+    if(previous >> ProgramShift != current >> ProgramShift)
+        ++programChanges;
+    if((previous >> TextureShift & TextureMask) != (current >> TextureShift & TextureMask))
+        ++textureChanges;
+    if((previous & MeshMask) != (current & MeshMask))
+        ++meshChanges;
+}
+
+}
+
+UnsignedLong RenderQueue::sortKey(const UnsignedInt program, const Int texture, const UnsignedInt mesh) {
+    CORRADE_INTERNAL_ASSERT(program < (1 << 16) && UnsignedInt(texture + 1) <= TextureMask && mesh <= MeshMask);
+    return UnsignedLong(program) << ProgramShift |
+           UnsignedLong(texture + 1) << TextureShift |
+           UnsignedLong(mesh);
+}
+
+void RenderQueue::add(InstanceBatch& batch, const Matrix4& transformationMatrix, const Color4& color) {
+    ++_current.drawables;
+
+    const UnsignedInt lod = batch.selectLod(transformationMatrix, _lodScale);
+    _current.triangles += batch.triangleCount(lod);
+    _current.fullDetailTriangles += batch.triangleCount(0);
+
+    /* Queue the batch on its first instance in this frame */
+    if(batch.add(transformationMatrix, color, lod))
+        _batches.emplace_back(batch.sortKey(), &batch);
+}
+
+void RenderQueue::submit() {
+    /* The batches are in order of their first instance now, count the state
+       changes they would need if drawn like this to compare with the same
+       draws sorted */
+    UnsignedLong unsortedKey = ~0ull;
+    for(const std::pair<UnsignedLong, InstanceBatch*>& item: _batches) {
+        countChanges(unsortedKey, item.first, _current.unsortedProgramChanges, _current.unsortedTextureChanges, _current.unsortedMeshChanges);
+        unsortedKey = item.first;
+    }
+
+    /* Each batch is in the queue only once, so the keys are unique */
+    std::sort(_batches.begin(), _batches.end());
+
+    UnsignedLong previousKey = ~0ull;
+    for(const std::pair<UnsignedLong, InstanceBatch*>& item: _batches) {
+        const UnsignedLong key = item.first;
+        InstanceBatch& batch = *item.second;
+
+        /* The camera and light uniforms are in a buffer shared by all
+           programs, so only the texture needs to be bound, and only when it
+           changes */
+        if(batch.texture() && (previousKey >> TextureShift & TextureMask) != (key >> TextureShift & TextureMask))
+            batch.shader().bindDiffuseTexture(*batch.texture());
+
+        countChanges(previousKey, key, _current.programChanges, _current.textureChanges, _current.meshChanges);
+        previousKey = key;
+
+        _current.drawCalls += batch.draw();
+    }
+
+    /* Reset for the next frame */
+    _statistics = _current;
+    _current = {};
+    _batches.clear();
+}
+
+}}
@@ -0,0 +1,127 @@
+#ifndef Magnum_Examples_RenderQueue_h
+#define Magnum_Examples_RenderQueue_h
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <utility>
+#include <vector>
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Color.h>
+#include <Magnum/Math/Matrix4.h>
+
+namespace Magnum { namespace Examples {
+
+class InstanceBatch;
+
+/**
+@brief Render queue sorted by GL state
+
+Drawable objects are added to the queue in the order they were loaded, which
+is rarely grouped by state. Each instance goes to its batch and each batch is
+queued once, at its first instance in given frame. On @ref submit() the
+batches are sorted by a packed 64-bit key with the program in the top bits,
+then the texture and then the mesh, so each program is switched to once and
+textures get rebound only when really needed. Uniforms shared by all draws
+are expected to be already uploaded through
+@ref InstancedPhongShader::bindFrameUniforms().
+*/
+class RenderQueue {
+    public:
+        /** @brief State changes done in a frame */
+        struct Statistics {
+            UnsignedInt drawables;      /**< Drawables added */
+            UnsignedInt drawCalls;      /**< Draw calls submitted */
+
+            /**
+             * Program, texture and mesh changes if the batches were drawn
+             * in order of their first instance, without sorting
+             */
+            UnsignedInt unsortedProgramChanges, unsortedTextureChanges, unsortedMeshChanges;
+
+            /** Program, texture and mesh changes actually done */
+            UnsignedInt programChanges, textureChanges, meshChanges;
+
+            UnsignedLong triangles;     /**< Triangles drawn */
+
+            /** Triangles that would be drawn without levels of detail */
+            UnsignedLong fullDetailTriangles;
+        };
+
+        /**
+         * @brief Sort key
+         *
+         * The @p program is expected to fit into 16 bits, @p texture and
+         * @p mesh into 24 bits. Use @cpp -1 @ce for no texture.
+         */
+        static UnsignedLong sortKey(UnsignedInt program, Int texture, UnsignedInt mesh);
+
+        /** @brief Scale for level of detail selection */
+        Float lodScale() const { return _lodScale; }
+
+        /**
+         * @brief Set scale for level of detail selection
+         *
+         * Projected size of a unit sphere at a unit distance in pixels,
+         * divided by the largest allowed error in pixels. For a perspective
+         * projection that's @cpp projection[1][1]*viewportHeight/2 @ce
+         * divided by the error. Set to @cpp 0.0f @ce to always draw the full
+         * detail, which is the default.
+         */
+        RenderQueue& setLodScale(Float scale) {
+            _lodScale = scale;
+            return *this;
+        }
+
+        /**
+         * @brief Add an instance of given batch
+         *
+         * The @p transformationMatrix is relative to the camera. Selects the
+         * level of detail for the instance based on @ref lodScale().
+         */
+        void add(InstanceBatch& batch, const Matrix4& transformationMatrix, const Color4& color);
+
+        /**
+         * @brief Sort and draw all queued batches
+         *
+         * Clears the queue for the next frame.
+         */
+        void submit();
+
+        /** @brief Statistics of the last submitted frame */
+        const Statistics& statistics() const { return _statistics; }
+
+    private:
+        std::vector<std::pair<UnsignedLong, InstanceBatch*>> _batches;
+        Float _lodScale{};
+        Statistics _current{}, _statistics{};
+};
+
+}}
+
+#endif
@@ -0,0 +1,131 @@
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "TextureStreamer.h"
+
+#include <algorithm>
+#include <Magnum/ImageView.h>
+#include <Magnum/GL/PixelFormat.h>
+#include <Magnum/GL/Texture.h>
+
+namespace Magnum { namespace Examples {
+
+void TextureStreamer::add(GL::Texture2D& texture, const PreparedScene& scene, const PreparedImage& image) {
+    const Containers::ArrayView<const PreparedLevel> levels = scene.levels(image);
+    const bool compressed = image.flags & PreparedImage::Compressed;
+
+    /* Upload the tail of the chain directly, it's small enough to not matter.
+       The smallest level always, so the texture is complete. Without a
+       budget everything is uploaded directly. */
+    Int firstLevel = levels.size();
+    while(firstLevel > 0 && (!_budget || firstLevel == Int(levels.size()) || levels[firstLevel - 1].size.max() <= ResidentLevelSize)) {
+        --firstLevel;
+        if(compressed)
+            texture.setCompressedSubImage(firstLevel, {}, CompressedImageView2D{CompressedPixelFormat(image.format), levels[firstLevel].size, scene.data(levels[firstLevel])});
+        else
+            texture.setSubImage(firstLevel, {}, ImageView2D{PixelFormat(image.format), levels[firstLevel].size, scene.data(levels[firstLevel])});
+    }
+
+    /* Sample only from the uploaded levels */
+    texture.setBaseLevel(firstLevel);
+
+    /* Queue the rest */
+    for(Int i = 0; i != firstLevel; ++i) {
+        _queue.push_back({&texture, image.format, compressed, i, levels[i].size, scene.data(levels[i])});
+        _pendingSize += levels[i].dataSize;
+        _sorted = false;
+    }
+}
+
+void TextureStreamer::setScene(PreparedScene&& scene) {
+    if(pendingLevelCount()) _scene.emplace(std::move(scene));
+}
+
+std::size_t TextureStreamer::update() {
+    if(!pendingLevelCount()) return 0;
+
+    /* Smallest levels first, so all textures get sharper at the same pace.
+       Levels of the same texture are always ordered from the smallest, as
+       the base level has to go down one level at a time. */
+    if(!_sorted) {
+        std::stable_sort(_queue.begin() + _next, _queue.end(), [](const Level& a, const Level& b) {
+            return a.data.size() < b.data.size() || (a.data.size() == b.data.size() && a.level > b.level);
+        });
+        _sorted = true;
+    }
+
+    /* Upload at least one level even if it's over budget, otherwise large
+       levels would never get uploaded */
+    std::size_t uploaded = 0;
+    while(_next != _queue.size() && (!uploaded || uploaded + _queue[_next].data.size() <= _budget)) {
+        upload(_queue[_next]);
+        uploaded += _queue[_next].data.size();
+        ++_next;
+    }
+    _pendingSize -= uploaded;
+
+    /* Everything uploaded, release the scene data and the pixel buffers */
+    if(!pendingLevelCount()) {
+        _queue = {};
+        _next = 0;
+        _scene = Containers::NullOpt;
+        for(Containers::Optional<GL::BufferImage2D>& buffer: _pixelBuffers)
+            buffer = Containers::NullOpt;
+        for(Containers::Optional<GL::CompressedBufferImage2D>& buffer: _compressedPixelBuffers)
+            buffer = Containers::NullOpt;
+    }
+
+    return uploaded;
+}
+
+void TextureStreamer::upload(const Level& level) {
+    /* Respecifying the buffer data orphans the previous storage, so the
+       driver doesn't need to wait for a pending upload from it */
+    const std::size_t pixelBuffer = _nextPixelBuffer;
+    _nextPixelBuffer = (_nextPixelBuffer + 1) % PixelBufferCount;
+    if(level.compressed) {
+        const GL::CompressedPixelFormat format = GL::compressedPixelFormat(CompressedPixelFormat(level.format));
+        Containers::Optional<GL::CompressedBufferImage2D>& buffer = _compressedPixelBuffers[pixelBuffer];
+        if(!buffer) buffer.emplace(format, level.size, level.data, GL::BufferUsage::StreamDraw);
+        else buffer->setData(format, level.size, level.data, GL::BufferUsage::StreamDraw);
+        level.texture->setCompressedSubImage(level.level, {}, *buffer);
+    } else {
+        const PixelFormat format = PixelFormat(level.format);
+        Containers::Optional<GL::BufferImage2D>& buffer = _pixelBuffers[pixelBuffer];
+        if(!buffer) buffer.emplace(GL::pixelFormat(format), GL::pixelType(format));
+        buffer->setData(GL::pixelFormat(format), GL::pixelType(format), level.size, level.data, GL::BufferUsage::StreamDraw);
+        level.texture->setSubImage(level.level, {}, *buffer);
+    }
+
+    /* The levels of each texture come in order, so this level is now the
+       largest complete one */
+    level.texture->setBaseLevel(level.level);
+}
+
+}}
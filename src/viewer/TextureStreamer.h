@@ -0,0 +1,133 @@
+#ifndef Magnum_Examples_TextureStreamer_h
+#define Magnum_Examples_TextureStreamer_h
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vector>
+#include <Corrade/Containers/ArrayView.h>
+#include <Corrade/Containers/Optional.h>
+#include <Magnum/PixelFormat.h>
+#include <Magnum/GL/BufferImage.h>
+#include <Magnum/GL/GL.h>
+
+#include "PreparedScene.h"
+
+namespace Magnum { namespace Examples {
+
+/**
+@brief Progressive texture streamer
+
+Uploads the small tail of each mip chain right away and queues the larger
+levels, which are then uploaded from the smallest to the largest over the
+following frames, at most given amount of bytes per frame. The texture base
+level always points to the largest uploaded level, so the textures are
+complete and sampled at the best available resolution at any time. The data
+go through pixel buffer objects, so the upload doesn't stall the pipeline.
+Both uncompressed and block-compressed images are supported.
+*/
+class TextureStreamer {
+    public:
+        /**
+         * @brief Levels with neither side larger than this are uploaded right away
+         *
+         * The smallest level is uploaded right away always.
+         */
+        enum: Int { ResidentLevelSize = 64 };
+
+        /**
+         * @brief Constructor
+         *
+         * If @p budget is @cpp 0 @ce, all levels are uploaded right away.
+         */
+        explicit TextureStreamer(std::size_t budget = 0): _budget{budget} {}
+
+        /** @brief Per-frame upload budget in bytes */
+        std::size_t budget() const { return _budget; }
+
+        /**
+         * @brief Add a texture
+         *
+         * Expects that the texture has storage allocated for the whole chain
+         * and that the image has more than one level. The texture is
+         * expected to stay at the same address until all levels are
+         * uploaded.
+         */
+        void add(GL::Texture2D& texture, const PreparedScene& scene, const PreparedImage& image);
+
+        /**
+         * @brief Keep the scene alive until all levels are uploaded
+         *
+         * The queued levels reference data of the scene passed to
+         * @ref add(), the scene is released once the queue is empty.
+         */
+        void setScene(PreparedScene&& scene);
+
+        /** @brief Count of levels waiting for upload */
+        std::size_t pendingLevelCount() const { return _queue.size() - _next; }
+
+        /** @brief Size of levels waiting for upload in bytes */
+        std::size_t pendingSize() const { return _pendingSize; }
+
+        /**
+         * @brief Upload queued levels
+         *
+         * Uploads levels until the budget is exhausted, but always at least
+         * one. Returns count of uploaded bytes.
+         */
+        std::size_t update();
+
+    private:
+        struct Level {
+            GL::Texture2D* texture;
+            UnsignedInt format;
+            bool compressed;
+            Int level;
+            Vector2i size;
+            Containers::ArrayView<const char> data;
+        };
+
+        void upload(const Level& level);
+
+        std::size_t _budget, _pendingSize{};
+        std::vector<Level> _queue;
+        std::size_t _next{};
+        bool _sorted{true};
+        Containers::Optional<PreparedScene> _scene;
+
+        /* Round-robin over a few pixel buffers, so a new upload doesn't need
+           to wait until the previous one from the same buffer is done */
+        enum: std::size_t { PixelBufferCount = 4 };
+        Containers::Optional<GL::BufferImage2D> _pixelBuffers[PixelBufferCount];
+        Containers::Optional<GL::CompressedBufferImage2D> _compressedPixelBuffers[PixelBufferCount];
+        std::size_t _nextPixelBuffer{};
+};
+
+}}
+
+#endif
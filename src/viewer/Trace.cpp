@@ -0,0 +1,109 @@
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "Trace.h"
+
+#include <sstream>
+
+namespace Magnum { namespace Examples {
+
+namespace {
+
+/* Small sequential thread IDs are easier to read in the timeline than the
+   system ones. The first thread to add an event is usually the main one. */
+UnsignedInt threadId() {
+    static std::atomic<UnsignedInt> next{0};
+    thread_local const UnsignedInt id = next++;
+    return id;
+}
+
+}
+
+std::string jsonEscape(const std::string& string) {
+    static const char hex[] = "0123456789abcdef";
+    std::string out;
+    out.reserve(string.size());
+    for(const char c: string) {
+        if(c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if(static_cast<unsigned char>(c) < 0x20) {
+            out += "\\u00";
+            out += hex[c >> 4];
+            out += hex[c & 0xf];
+        } else out += c;
+    }
+    return out;
+}
+
+Tracer& Tracer::global() {
+    static Tracer tracer;
+    return tracer;
+}
+
+void Tracer::setEnabled(const bool enabled) {
+    std::lock_guard<std::mutex> lock{_mutex};
+    if(enabled && !_enabled) {
+        _events.clear();
+        _start = std::chrono::steady_clock::now();
+    }
+    _enabled = enabled;
+}
+
+std::size_t Tracer::eventCount() const {
+    std::lock_guard<std::mutex> lock{_mutex};
+    return _events.size();
+}
+
+void Tracer::add(const char* const category, std::string name, const std::chrono::steady_clock::time_point start, const std::chrono::steady_clock::time_point end) {
+    if(!_enabled) return;
+
+    const UnsignedInt thread = threadId();
+    std::lock_guard<std::mutex> lock{_mutex};
+    _events.push_back({category, std::move(name), thread,
+        std::chrono::duration_cast<std::chrono::microseconds>(start - _start).count(),
+        std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()});
+}
+
+std::string Tracer::json() const {
+    std::lock_guard<std::mutex> lock{_mutex};
+    std::ostringstream out;
+    out << "{\"traceEvents\": [";
+    for(std::size_t i = 0; i != _events.size(); ++i) {
+        const Event& event = _events[i];
+        out << (i ? ",\n" : "\n") << "  {\"name\": \"" << jsonEscape(event.name)
+            << "\", \"cat\": \"" << event.category << "\", \"ph\": \"X\", \"ts\": "
+            << event.start << ", \"dur\": " << event.duration
+            << ", \"pid\": 0, \"tid\": " << event.thread << "}";
+    }
+    out << "\n], \"displayTimeUnit\": \"ms\"}\n";
+    return out.str();
+}
+
+}}
@@ -0,0 +1,136 @@
+#ifndef Magnum_Examples_Trace_h
+#define Magnum_Examples_Trace_h
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <Magnum/Magnum.h>
+
+namespace Magnum { namespace Examples {
+
+/**
+@brief Escape a string for use in JSON
+
+Escapes quotes and backslashes and writes control characters as `\u00XX`.
+Shared by all JSON output of the viewer.
+*/
+std::string jsonEscape(const std::string& string);
+
+/**
+@brief Collector of timed events
+
+Collects durations of named events from any thread and saves them in the
+Chrome trace event format, which can be opened in `chrome://tracing` or
+[Perfetto](https://ui.perfetto.dev) to see a timeline of what each thread was
+doing. Disabled by default, in which case @ref TraceScope does nothing except
+checking a flag. Events are usually added through @ref TraceScope instead of
+calling @ref add() directly.
+*/
+class Tracer {
+    public:
+        /** @brief Global instance */
+        static Tracer& global();
+
+        /** @brief Whether the tracer is enabled */
+        bool isEnabled() const { return _enabled; }
+
+        /**
+         * @brief Enable or disable the tracer
+         *
+         * Enabling clears all previously collected events, timestamps are
+         * then relative to this call.
+         */
+        void setEnabled(bool enabled);
+
+        /** @brief Count of collected events */
+        std::size_t eventCount() const;
+
+        /**
+         * @brief Add an event
+         *
+         * The event is attributed to the calling thread. Does nothing if the
+         * tracer is disabled.
+         */
+        void add(const char* category, std::string name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+        /** @brief Collected events in the Chrome trace event format */
+        std::string json() const;
+
+    private:
+        struct Event {
+            const char* category;
+            std::string name;
+            UnsignedInt thread;
+            Long start, duration;   /* Microseconds */
+        };
+
+        std::atomic<bool> _enabled{};
+        std::chrono::steady_clock::time_point _start;
+        mutable std::mutex _mutex;
+        std::vector<Event> _events;
+};
+
+/**
+@brief Scoped trace event
+
+Adds an event to @ref Tracer::global() spanning the lifetime of this object.
+The @p category and @p name are expected to be string literals. If @p id is
+not @cpp -1 @ce, it's appended to the name, which is formatted only if the
+tracer is enabled.
+*/
+class TraceScope {
+    public:
+        explicit TraceScope(const char* category, const char* name, Long id = -1): _category{category}, _name{name}, _id{id}, _enabled{Tracer::global().isEnabled()} {
+            if(_enabled) _start = std::chrono::steady_clock::now();
+        }
+
+        TraceScope(const TraceScope&) = delete;
+        TraceScope& operator=(const TraceScope&) = delete;
+
+        ~TraceScope() {
+            if(_enabled) Tracer::global().add(_category,
+                _id == -1 ? std::string{_name} : _name + (' ' + std::to_string(_id)),
+                _start, std::chrono::steady_clock::now());
+        }
+
+    private:
+        const char* _category;
+        const char* _name;
+        Long _id;
+        bool _enabled;
+        std::chrono::steady_clock::time_point _start;
+};
+
+}}
+
+#endif
@@ -0,0 +1,78 @@
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "TransformHierarchy.h"
+
+#include <algorithm>
+#include <Corrade/Utility/Assert.h>
+
+namespace Magnum { namespace Examples {
+
+UnsignedInt TransformHierarchy::add(const Int parent, const Matrix4& transformation) {
+    CORRADE_INTERNAL_ASSERT(parent < Int(_parents.size()));
+
+    /* The world transformation gets calculated on next update */
+    _firstDirty = std::min(_firstDirty, _parents.size());
+    _parents.push_back(parent);
+    _transformations.push_back(transformation);
+    _worldTransformations.emplace_back();
+    _dirty.push_back(true);
+    return _parents.size() - 1;
+}
+
+void TransformHierarchy::setTransformation(const UnsignedInt node, const Matrix4& transformation) {
+    _transformations[node] = transformation;
+    _dirty[node] = true;
+    _firstDirty = std::min(_firstDirty, std::size_t(node));
+}
+
+std::size_t TransformHierarchy::update() {
+    /* Parents are always before children, so the dirty flag propagates
+       down the hierarchy in a single pass and parent world transformation is
+       always up-to-date when its children get to it. Nothing before the
+       first dirty node can be affected. */
+    std::size_t updated = 0;
+    for(std::size_t i = _firstDirty; i < _parents.size(); ++i) {
+        const Int parent = _parents[i];
+        if(parent != -1 && _dirty[parent]) _dirty[i] = true;
+        if(!_dirty[i]) continue;
+
+        _worldTransformations[i] = parent == -1 ? _transformations[i] :
+            _worldTransformations[parent]*_transformations[i];
+        ++updated;
+    }
+
+    /* The flags are needed during the whole pass, clear them after */
+    if(_firstDirty < _dirty.size())
+        std::fill(_dirty.begin() + _firstDirty, _dirty.end(), 0);
+    _firstDirty = _parents.size();
+    return updated;
+}
+
+}}
@@ -0,0 +1,102 @@
+#ifndef Magnum_Examples_TransformHierarchy_h
+#define Magnum_Examples_TransformHierarchy_h
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <vector>
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Matrix4.h>
+
+namespace Magnum { namespace Examples {
+
+/**
+@brief Flattened transformation hierarchy
+
+Stores parent indices, local and world transformations of all nodes in
+separate contiguous arrays, with parents always before their children. Changing
+a local transformation only marks the node as dirty, @ref update() then
+recomputes world transformations of dirty nodes and everything under them in
+a single linear pass, starting at the first dirty node. A static hierarchy
+costs nothing.
+*/
+class TransformHierarchy {
+    public:
+        /** @brief Node count */
+        std::size_t size() const { return _parents.size(); }
+
+        /**
+         * @brief Add a node
+         *
+         * The @p parent is expected to be either @cpp -1 @ce or an index of
+         * an existing node. Returns index of the new node.
+         */
+        UnsignedInt add(Int parent, const Matrix4& transformation);
+
+        /** @brief Parent index or @cpp -1 @ce */
+        Int parent(UnsignedInt node) const { return _parents[node]; }
+
+        /** @brief Local transformation */
+        const Matrix4& transformation(UnsignedInt node) const {
+            return _transformations[node];
+        }
+
+        /**
+         * @brief Set local transformation
+         *
+         * Marks the node as dirty, the world transformation is updated on
+         * next @ref update().
+         */
+        void setTransformation(UnsignedInt node, const Matrix4& transformation);
+
+        /**
+         * @brief World transformation
+         *
+         * Valid only after @ref update() if any nodes are dirty.
+         */
+        const Matrix4& worldTransformation(UnsignedInt node) const {
+            return _worldTransformations[node];
+        }
+
+        /**
+         * @brief Update world transformations of dirty nodes
+         *
+         * Returns count of recalculated world transformations.
+         */
+        std::size_t update();
+
+    private:
+        std::vector<Int> _parents;
+        std::vector<Matrix4> _transformations, _worldTransformations;
+        std::vector<UnsignedByte> _dirty;
+        std::size_t _firstDirty{};
+};
+
+}}
+
+#endif
@@ -0,0 +1,201 @@
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <Corrade/Utility/Arguments.h>
+#include <Corrade/Utility/Directory.h>
+#include <Magnum/GL/Framebuffer.h>
+#include <Magnum/GL/Renderbuffer.h>
+#include <Magnum/GL/RenderbufferFormat.h>
+#include <Magnum/GL/Renderer.h>
+#include <Magnum/Math/ConfigurationValue.h>
+#include <Magnum/Platform/WindowlessEglApplication.h>
+#include <Magnum/SceneGraph/Camera.h>
+
+#include "ViewerScene.h"
+
+namespace Magnum { namespace Examples {
+
+using namespace Math::Literals;
+
+class ViewerBenchmark: public Platform::WindowlessApplication {
+    public:
+        explicit ViewerBenchmark(const Arguments& arguments);
+
+        int exec() override;
+
+    private:
+        Utility::Arguments _args;
+};
+
+ViewerBenchmark::ViewerBenchmark(const Arguments& arguments): Platform::WindowlessApplication{arguments} {
+    ViewerScene::addArguments(_args);
+    _args.addOption("frames", "100").setHelp("frames", "number of measured frames, covering one full orbit")
+        .addOption("warmup-frames", "5").setHelp("warmup-frames", "number of frames rendered before measuring")
+        .addOption("size", "1280 720").setHelp("size", "framebuffer size")
+        .addBooleanOption("no-culling").setHelp("no-culling", "disable frustum culling")
+        .addBooleanOption("no-occlusion-culling").setHelp("no-occlusion-culling", "disable occlusion culling")
+        .addOption("output").setHelp("output", "file to write the JSON report to instead of standard output")
+        .addSkippedPrefix("magnum").setHelp("engine-specific options")
+        .setHelp("Renders a camera orbit around a 3D scene file provided on command line into an offscreen framebuffer and prints frame and load timings as JSON.")
+        .parse(arguments.argc, arguments.argv);
+}
+
+int ViewerBenchmark::exec() {
+    const UnsignedInt frameCount = _args.value<UnsignedInt>("frames");
+    const UnsignedInt warmupFrameCount = _args.value<UnsignedInt>("warmup-frames");
+    const Vector2i size = _args.value<Vector2i>("size");
+    if(!frameCount || !size.product()) {
+        Error{} << "The frame count and framebuffer size can't be zero";
+        return 1;
+    }
+
+    /* Print all diagnostics to the standard error output so the standard
+       output contains just the report */
+    Debug redirectDebug{&std::cerr};
+
+    /* Offscreen framebuffer to render to */
+    GL::Renderbuffer color, depth;
+    color.setStorage(GL::RenderbufferFormat::RGBA8, size);
+    depth.setStorage(GL::RenderbufferFormat::DepthComponent24, size);
+    GL::Framebuffer framebuffer{{{}, size}};
+    framebuffer
+        .attachRenderbuffer(GL::Framebuffer::ColorAttachment{0}, color)
+        .attachRenderbuffer(GL::Framebuffer::BufferAttachment::Depth, depth);
+    CORRADE_INTERNAL_ASSERT(framebuffer.checkStatus(GL::FramebufferTarget::Draw) == GL::Framebuffer::Status::Complete);
+    framebuffer.bind();
+
+    ViewerScene scene{_args, size};
+    scene.setCullingEnabled(!_args.isSet("no-culling"));
+    scene.setOcclusionCullingEnabled(!_args.isSet("no-occlusion-culling"));
+
+    /* Orbit the camera around the scene origin, one full turn over all
+       measured frames. Wait for the GL to finish each frame, as most of the
+       work is otherwise deferred and the timing would be meaningless. Also
+       count how many frames it took to stream all textures and how many
+       objects got culled by occlusion. */
+    const Matrix4 cameraTransformation = scene.cameraObject().transformationMatrix();
+    std::vector<Double> frameTimes;
+    frameTimes.reserve(frameCount);
+    UnsignedInt textureStreamingFrames = 0;
+    std::size_t occludedObjects = 0, maxOccludedObjects = 0;
+    for(UnsignedInt i = 0; i != warmupFrameCount + frameCount; ++i) {
+        scene.cameraObject().setTransformation(Matrix4::rotationY(360.0_degf*Float(i)/Float(frameCount))*cameraTransformation);
+        if(scene.pendingTextureSize()) ++textureStreamingFrames;
+
+        const std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+        framebuffer.clear(GL::FramebufferClear::Color|GL::FramebufferClear::Depth);
+        scene.draw();
+        GL::Renderer::finish();
+        const std::chrono::duration<double, std::milli> frameDuration = std::chrono::steady_clock::now() - frameStart;
+
+        if(i >= warmupFrameCount) {
+            frameTimes.push_back(frameDuration.count());
+            occludedObjects += scene.occludedObjectCount();
+            maxOccludedObjects = std::max(maxOccludedObjects, scene.occludedObjectCount());
+        }
+    }
+
+    /* Nearest-rank percentiles */
+    std::sort(frameTimes.begin(), frameTimes.end());
+    const std::size_t n = frameTimes.size();
+    const Double median = n % 2 ? frameTimes[n/2] : (frameTimes[n/2 - 1] + frameTimes[n/2])*0.5;
+    const Double p99 = frameTimes[std::max(std::size_t((n*99 + 99)/100), std::size_t{1}) - 1];
+    Double mean = 0.0;
+    for(const Double time: frameTimes) mean += time;
+    mean /= n;
+
+    const ViewerScene::Timings& timings = scene.timings();
+    const RenderQueue::Statistics& statistics = scene.renderStatistics();
+    const MemoryTracker& memory = scene.memory();
+    std::ostringstream out;
+    out << "{\n"
+        << "  \"size\": [" << size.x() << ", " << size.y() << "],\n"
+        << "  \"frames\": " << frameCount << ",\n"
+        << "  \"culling\": " << (scene.isCullingEnabled() ? "true" : "false") << ",\n"
+        << "  \"occlusionCulling\": " << (scene.isOcclusionCullingEnabled() ? "true" : "false") << ",\n"
+        << "  \"occluders\": " << scene.occluderCount() << ",\n"
+        << "  \"lodError\": " << _args.value<Float>("lod-error") << ",\n"
+        << "  \"textureBudgetKb\": " << _args.value<UnsignedInt>("texture-budget") << ",\n"
+        << "  \"textureStreamingFrames\": " << textureStreamingFrames << ",\n"
+        << "  \"loadMs\": {\n"
+        << "    \"cached\": " << (timings.cached ? "true" : "false") << ",\n"
+        << "    \"importThreads\": " << timings.importThreads << ",\n"
+        << "    \"import\": " << timings.import << ",\n"
+        << "    \"serialImport\": " << timings.serialImport << ",\n"
+        << "    \"prepare\": " << timings.prepare << ",\n"
+        << "    \"upload\": " << timings.upload << ",\n"
+        << "    \"populate\": " << timings.populate << ",\n"
+        << "    \"total\": " << timings.total << "\n"
+        << "  },\n"
+        << "  \"frameMs\": {\n"
+        << "    \"min\": " << frameTimes.front() << ",\n"
+        << "    \"median\": " << median << ",\n"
+        << "    \"p99\": " << p99 << ",\n"
+        << "    \"max\": " << frameTimes.back() << ",\n"
+        << "    \"mean\": " << mean << "\n"
+        << "  },\n"
+        << "  \"occludedObjects\": {\n"
+        << "    \"mean\": " << Double(occludedObjects)/n << ",\n"
+        << "    \"max\": " << maxOccludedObjects << "\n"
+        << "  },\n"
+        << "  \"lastFrame\": {\n"
+        << "    \"objects\": " << scene.objectCount() << ",\n"
+        << "    \"visibleObjects\": " << scene.visibleObjectCount() << ",\n"
+        << "    \"occludedObjects\": " << scene.occludedObjectCount() << ",\n"
+        << "    \"drawCalls\": " << statistics.drawCalls << ",\n"
+        << "    \"triangles\": " << statistics.triangles << ",\n"
+        << "    \"fullDetailTriangles\": " << statistics.fullDetailTriangles << "\n"
+        << "  },\n"
+        << "  \"memoryKb\": {\n"
+        << "    \"total\": " << memory.total()/1024 << ",\n"
+        << "    \"peak\": " << memory.peak()/1024 << ",\n"
+        << "    \"buffers\": " << memory.total(MemoryTracker::Type::Buffer)/1024 << ",\n"
+        << "    \"textures\": " << memory.total(MemoryTracker::Type::Texture2D)/1024 << ",\n"
+        << "    \"cpu\": " << memory.total(MemoryTracker::Type::CpuData)/1024 << "\n"
+        << "  }\n"
+        << "}\n";
+
+    if(!_args.value("output").empty()) {
+        if(!Utility::Directory::writeString(_args.value("output"), out.str())) {
+            Error{} << "Cannot write the report to" << _args.value("output");
+            return 2;
+        }
+    } else std::cout << out.str();
+
+    return 0;
+}
+
+}}
+
+MAGNUM_WINDOWLESSAPPLICATION_MAIN(Magnum::Examples::ViewerBenchmark)
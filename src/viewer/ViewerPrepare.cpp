@@ -0,0 +1,281 @@
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <Corrade/PluginManager/Manager.h>
+#include <Corrade/Utility/Arguments.h>
+#include <Corrade/Utility/Directory.h>
+#include <Corrade/Utility/String.h>
+#include <Magnum/Trade/AbstractImporter.h>
+
+#include "Import.h"
+#include "Parallel.h"
+#include "PreparedScene.h"
+#include "Trace.h"
+
+using namespace Magnum;
+using namespace Magnum::Examples;
+
+namespace {
+
+/* Timings and sizes of a single prepared file */
+struct FileReport {
+    std::string file;
+    Int status;                 /* Process exit code, 0 on success */
+    bool skipped;               /* The cache was already up-to-date */
+    Double import, total;       /* Milliseconds */
+    UnsignedLong sourceSize, importedImageSize, outputSize;
+    PrepareStatistics statistics;
+};
+
+std::string lowercase(std::string string) {
+    std::transform(string.begin(), string.end(), string.begin(), [](char c) {
+        return char(std::tolower(static_cast<unsigned char>(c)));
+    });
+    return string;
+}
+
+/* Import a file, prepare it and save it to <file>.cache */
+void prepareFile(PluginManager::Manager<Trade::AbstractImporter>& manager, const Utility::Arguments& args, const UnsignedInt threadCount, FileReport& report) {
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const std::string cacheFile = report.file + ".cache";
+    const PrepareFlags flags = prepareFlagsFromArguments(args);
+    if(args.isSet("skip-up-to-date") && PreparedScene::open(cacheFile, report.file, flags)) {
+        report.skipped = true;
+        return;
+    }
+
+    /* Record the files the scene is made from before importing them, so a
+       change done meanwhile makes the cache stale */
+    const std::vector<SourceFile> sources = sourceFiles(report.file);
+    for(const SourceFile& source: sources) report.sourceSize += source.size;
+
+    std::unique_ptr<Trade::AbstractImporter> importer = manager.loadAndInstantiate(args.value("importer"));
+    if(!importer) {
+        report.status = 1;
+        return;
+    }
+
+    Debug{} << "Opening file" << report.file;
+    if(!importer->openFile(report.file)) {
+        report.status = 4;
+        return;
+    }
+
+    const ImportedData data = importData(*importer, args.value("importer"), report.file, threadCount);
+    for(const Containers::Optional<Trade::ImageData2D>& image: data.images)
+        if(image) report.importedImageSize += image->data().size();
+    report.import = std::chrono::duration<double, std::milli>{std::chrono::steady_clock::now() - start}.count();
+
+    const PreparedScene scene = PreparedScene::prepare(data, sources, flags, threadCount);
+    report.statistics = scene.statistics();
+    report.outputSize = scene.size();
+    if(!scene.save(cacheFile)) {
+        report.status = 5;
+        return;
+    }
+
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    report.total = std::chrono::duration<double, std::milli>{end - start}.count();
+    Tracer::global().add("file", report.file, start, end);
+    Debug{} << "Saved prepared scene to" << cacheFile << "in" << report.total << "ms";
+}
+
+void printReport(const FileReport& report) {
+    if(report.skipped) {
+        Debug{} << report.file << "is up-to-date";
+        return;
+    }
+    if(report.status) {
+        Error{} << report.file << "failed with status" << report.status;
+        return;
+    }
+
+    const PrepareStatistics& s = report.statistics;
+    Debug{} << report.file << "prepared in" << report.total << "ms";
+    Debug{} << "  import" << report.import << "ms, images" << s.convertImages
+        << "ms, meshes" << s.optimizeMeshes << "ms, mipmaps" << s.generateMipmaps
+        << "ms, compression" << s.compressTextures << "ms, deduplication"
+        << s.deduplicate << "ms, layout" << s.layout << "ms";
+    Debug{} << "  source" << report.sourceSize/1024 << "kB, images"
+        << report.importedImageSize/1024 << "->" << s.textureDataSize/1024
+        << "kB, vertices" << s.originalVertexDataSize/1024 << "->"
+        << s.vertexDataSize/1024 << "kB, indices" << s.indexDataSize/1024
+        << "kB, output" << report.outputSize/1024 << "kB";
+}
+
+std::string jsonReport(const std::vector<FileReport>& reports) {
+    std::ostringstream out;
+    out << "[";
+    for(std::size_t i = 0; i != reports.size(); ++i) {
+        const FileReport& report = reports[i];
+        const PrepareStatistics& s = report.statistics;
+        out << (i ? ",\n" : "\n")
+            << "  {\n"
+            << "    \"file\": \"" << jsonEscape(report.file) << "\",\n"
+            << "    \"status\": " << report.status << ",\n"
+            << "    \"skipped\": " << (report.skipped ? "true" : "false") << ",\n"
+            << "    \"ms\": {\n"
+            << "      \"import\": " << report.import << ",\n"
+            << "      \"convertImages\": " << s.convertImages << ",\n"
+            << "      \"optimizeMeshes\": " << s.optimizeMeshes << ",\n"
+            << "      \"generateMipmaps\": " << s.generateMipmaps << ",\n"
+            << "      \"compressTextures\": " << s.compressTextures << ",\n"
+            << "      \"deduplicate\": " << s.deduplicate << ",\n"
+            << "      \"layout\": " << s.layout << ",\n"
+            << "      \"total\": " << report.total << "\n"
+            << "    },\n"
+            << "    \"bytes\": {\n"
+            << "      \"source\": " << report.sourceSize << ",\n"
+            << "      \"importedImages\": " << report.importedImageSize << ",\n"
+            << "      \"convertedImages\": " << s.imageDataSize << ",\n"
+            << "      \"textures\": " << s.textureDataSize << ",\n"
+            << "      \"originalVertices\": " << s.originalVertexDataSize << ",\n"
+            << "      \"vertices\": " << s.vertexDataSize << ",\n"
+            << "      \"indices\": " << s.indexDataSize << ",\n"
+            << "      \"output\": " << report.outputSize << "\n"
+            << "    }\n"
+            << "  }";
+    }
+    out << "\n]\n";
+    return out.str();
+}
+
+}
+
+/* Offline counterpart of the viewer --cache option. Imports the scene,
+   prepares it with the same options as the viewer and saves <file>.cache, so
+   the slow steps such as texture compression don't need to happen on the
+   first viewer start. No GL context is needed.
+
+   Given a directory, all scene files in it are prepared. The files are
+   handed out to a pool of threads one by one, so a large scene doesn't hold
+   up the rest, and each file is processed on its share of the cores. */
+int main(int argc, char** argv) {
+    Utility::Arguments args;
+    args.addArgument("path").setHelp("path", "file to prepare or a directory with scene files")
+        .addOption("importer", "AnySceneImporter").setHelp("importer", "importer plugin to use")
+        .addOption("import-threads", "0").setHelp("import-threads", "number of threads to decode and prepare each file on, 0 for all cores divided by the jobs")
+        .addOption("jobs", "0").setHelp("jobs", "number of files from a directory prepared at the same time, 0 for all cores")
+        .addOption("extensions", "gltf glb obj dae fbx ply ogex").setHelp("extensions", "extensions of scene files in a directory")
+        .addBooleanOption("skip-up-to-date").setHelp("skip-up-to-date", "don't prepare files that have an up-to-date cache")
+        .addBooleanOption("verbose").setHelp("verbose", "print diagnostics of each file in a directory, not just the report")
+        .addOption("report").setHelp("report", "file to write a JSON report with timings and sizes to")
+        .addOption("trace").setHelp("trace", "file to save a Chrome trace of all files to");
+    addPrepareArguments(args);
+    args.setGlobalHelp("Prepares a scene for the viewer, saving it to <file>.cache. Run the viewer with the same options and --cache to use it.")
+        .parse(argc, argv);
+
+    /* Listing a directory gives at least . and .., listing a file nothing */
+    const std::string& path = args.value("path");
+    const std::vector<std::string> entries = Utility::Directory::list(path, Utility::Directory::Flag::SortAscending);
+    const bool directory = !entries.empty();
+    std::vector<FileReport> reports;
+    if(directory) {
+        const std::vector<std::string> extensions = Utility::String::splitWithoutEmptyParts(lowercase(args.value("extensions")), ' ');
+        for(const std::string& entry: entries) {
+            const std::size_t dot = entry.rfind('.');
+            if(dot == std::string::npos || dot == 0 || std::find(extensions.begin(), extensions.end(), lowercase(entry.substr(dot + 1))) == extensions.end())
+                continue;
+            reports.push_back(FileReport{});
+            reports.back().file = Utility::Directory::join(path, entry);
+        }
+        Debug{} << "Preparing" << reports.size() << "scene files in" << path;
+    } else {
+        reports.push_back(FileReport{});
+        reports.back().file = path;
+    }
+
+    /* Plugin managers aren't thread-safe, each job gets its own */
+    const UnsignedInt jobCount = directory ? std::min(resolveThreadCount(args.value<UnsignedInt>("jobs")), UnsignedInt(std::max(reports.size(), std::size_t{1}))) : 1;
+    const UnsignedInt threadCount = args.value<UnsignedInt>("import-threads") ?
+        args.value<UnsignedInt>("import-threads") :
+        std::max(resolveThreadCount(0)/jobCount, 1u);
+    std::vector<std::unique_ptr<PluginManager::Manager<Trade::AbstractImporter>>> managers(jobCount);
+    for(auto& manager: managers)
+        manager.reset(new PluginManager::Manager<Trade::AbstractImporter>);
+
+    /* Diagnostic output is redirected per thread, so each file's output is
+       collected and printed together with its report instead of
+       interleaving with other files. The redirection doesn't reach the
+       threads that importData() and prepare() spawn themselves, so whatever
+       the importer plugins or the image compression print there still goes
+       directly to the console. */
+    const std::string& traceFile = args.value("trace");
+    if(!traceFile.empty()) Tracer::global().setEnabled(true);
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::mutex outputMutex;
+    parallelFor(jobCount, reports.size(), [&](const UnsignedInt job, const std::size_t i) {
+        if(!directory) {
+            prepareFile(*managers[job], args, threadCount, reports[i]);
+            return;
+        }
+
+        std::ostringstream out;
+        {
+            Debug redirectDebug{args.isSet("verbose") ? &out : nullptr};
+            Warning redirectWarning{&out};
+            Error redirectError{&out};
+            prepareFile(*managers[job], args, threadCount, reports[i]);
+        }
+
+        std::lock_guard<std::mutex> lock{outputMutex};
+        Debug{Debug::Flag::NoNewlineAtTheEnd} << out.str();
+        printReport(reports[i]);
+    });
+
+    Int status = 0;
+    std::size_t failedCount = 0, skippedCount = 0;
+    for(const FileReport& report: reports) {
+        status = std::max(status, report.status);
+        if(report.status) ++failedCount;
+        if(report.skipped) ++skippedCount;
+    }
+    if(directory) Debug{} << "Prepared" << reports.size() - failedCount - skippedCount
+        << "files," << skippedCount << "up-to-date and" << failedCount
+        << "failed on" << jobCount << "jobs with" << threadCount
+        << "threads each in" << std::chrono::duration<double, std::milli>{std::chrono::steady_clock::now() - start}.count() << "ms";
+    else printReport(reports.front());
+
+    if(!args.value("report").empty() && !Utility::Directory::writeString(args.value("report"), jsonReport(reports))) {
+        Error{} << "Cannot write the report to" << args.value("report");
+        return 6;
+    }
+    if(!traceFile.empty() && !Utility::Directory::writeString(traceFile, Tracer::global().json())) {
+        Error{} << "Cannot write the trace to" << traceFile;
+        return 6;
+    }
+
+    return status;
+}
@@ -0,0 +1,568 @@
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ViewerScene.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <Corrade/PluginManager/Manager.h>
+#include <Corrade/Utility/Arguments.h>
+#include <Corrade/Utility/Directory.h>
+#include <Magnum/Array.h>
+#include <Magnum/Mesh.h>
+#include <Magnum/PixelFormat.h>
+#include <Magnum/Sampler.h>
+#include <Magnum/GL/OpenGL.h>
+#include <Magnum/GL/PixelFormat.h>
+#include <Magnum/GL/Renderer.h>
+#include <Magnum/GL/TextureFormat.h>
+#include <Magnum/SceneGraph/Camera.h>
+#include <Magnum/Trade/AbstractImporter.h>
+
+#include "Import.h"
+#include "Parallel.h"
+#include "PreparedScene.h"
+#include "Trace.h"
+
+namespace Magnum { namespace Examples {
+
+using namespace Math::Literals;
+
+namespace {
+
+/* Compressed formats the GPU can sample from. RGTC formats are core since
+   OpenGL 3.0, but not listed as they're not meant for general use. */
+std::vector<GL::CompressedPixelFormat> supportedCompressedFormats() {
+    GLint count{};
+    glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &count);
+    std::vector<GLint> formats(count);
+    if(count) glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+
+    std::vector<GL::CompressedPixelFormat> out;
+    for(const GLint format: formats)
+        out.push_back(GL::CompressedPixelFormat(format));
+    #ifndef MAGNUM_TARGET_GLES
+    out.push_back(GL::CompressedPixelFormat::RGRgtc2Unorm);
+    #endif
+    return out;
+}
+
+/* Occluders with more triangles would take too long to rasterize */
+constexpr UnsignedInt MaxOccluderTriangles = 4096;
+
+/* Triangles of the full-detail level as a flat list of positions, or nothing
+   if the indices are out of range. Coarser levels may bulge out of the actual
+   surface and hide objects that are visible. */
+std::vector<Vector3> occluderTriangles(const PreparedScene& scene, const PreparedMesh& mesh) {
+    const bool quantized = mesh.flags & PreparedMesh::Quantized;
+    const std::size_t stride = vertexStride(mesh);
+    const Containers::ArrayView<const char> vertexData = scene.vertexData(mesh);
+    const Containers::ArrayView<const char> indexData = scene.indexData(mesh);
+    const PreparedLod& lod = mesh.lods[0];
+
+    std::vector<Vector3> out(lod.count);
+    for(std::size_t i = 0; i != lod.count; ++i) {
+        std::size_t index = i;
+        const char* const indexPointer = indexData.data() + (lod.indexOffset + i)*mesh.indexSize;
+        if(mesh.indexSize == 1) {
+            UnsignedByte value;
+            std::memcpy(&value, indexPointer, 1);
+            index = value;
+        } else if(mesh.indexSize == 2) {
+            UnsignedShort value;
+            std::memcpy(&value, indexPointer, 2);
+            index = value;
+        } else if(mesh.indexSize == 4) {
+            UnsignedInt value;
+            std::memcpy(&value, indexPointer, 4);
+            index = value;
+        }
+        if((index + 1)*stride > vertexData.size()) return {};
+
+        const char* const vertex = vertexData.data() + index*stride;
+        if(quantized) {
+            UnsignedShort position[3];
+            std::memcpy(position, vertex, sizeof(position));
+            out[i] = mesh.bounds.min() + Vector3{Float(position[0]), Float(position[1]), Float(position[2])}/65535.0f*mesh.bounds.size();
+        } else std::memcpy(&out[i], vertex, sizeof(Vector3));
+    }
+
+    return out;
+}
+
+}
+
+void ViewerScene::addArguments(Utility::Arguments& args) {
+    args.addArgument("file").setHelp("file", "file to load")
+        .addOption("importer", "AnySceneImporter").setHelp("importer", "importer plugin to use")
+        .addOption("import-threads", "0").setHelp("import-threads", "number of threads to decode images and meshes on, 0 for all cores")
+        .addBooleanOption("compare-serial").setHelp("compare-serial", "decode everything once more on a single thread and print the speedup")
+        .addBooleanOption("cache").setHelp("cache", "load the scene from a prepared <file>.cache file, creating it if it doesn't exist or is stale")
+        .addOption("texture-budget", "4096").setHelp("texture-budget", "texture data streamed to the GPU per frame in kB, 0 to upload everything on startup")
+        .addOption("lod-error", "1.0").setHelp("lod-error", "largest allowed on-screen error of simplified meshes in pixels, 0 to always draw the full detail")
+        .addOption("trace").setHelp("trace", "file to save a Chrome trace of the scene loading to")
+        .addOption("occluders", "16").setHelp("occluders", "count of the largest objects used as occluders if the scene has no objects named as such, 0 to disable occlusion culling");
+    addPrepareArguments(args);
+}
+
+ViewerScene::ViewerScene(const Utility::Arguments& args, const Vector2i& viewportSize) {
+    /* Every scene needs a camera */
+    _cameraObject
+        .setParent(&_scene)
+        .translate(Vector3::zAxis(5.0f));
+    (*(_camera = new SceneGraph::Camera3D{_cameraObject}))
+        .setAspectRatioPolicy(SceneGraph::AspectRatioPolicy::Extend)
+        .setProjectionMatrix(Matrix4::perspectiveProjection(35.0_degf, 1.0f, 0.01f, 1000.0f))
+        .setViewport(viewportSize);
+
+    /* Base object, parent of all (for easy manipulation) */
+    _manipulator.setParent(&_scene);
+
+    _lodError = args.value<Float>("lod-error");
+
+    /* Setup renderer and shader defaults */
+    GL::Renderer::enable(GL::Renderer::Feature::DepthTest);
+    GL::Renderer::enable(GL::Renderer::Feature::FaceCulling);
+    _coloredShader
+        .setAmbientColor(0x111111_rgbf)
+        .setSpecularColor(0xffffff_rgbf)
+        .setShininess(80.0f);
+    _texturedShader
+        .setAmbientColor(0x111111_rgbf)
+        .setSpecularColor(0x111111_rgbf)
+        .setShininess(80.0f);
+
+    /* Collect timings of all loading phases and individual resources, if
+       requested */
+    const std::string& traceFile = args.value("trace");
+    if(!traceFile.empty()) Tracer::global().setEnabled(true);
+
+    const std::chrono::steady_clock::time_point startupStart = std::chrono::steady_clock::now();
+    _timings = {};
+    const std::string& file = args.value("file");
+    const std::string cacheFile = file + ".cache";
+
+    /* The flags are shared with the offline preparation tool, so a scene
+       prepared by it is picked up from the cache if it used the same
+       options */
+    _textureStreamer = TextureStreamer{args.value<std::size_t>("texture-budget")*1024};
+    const PrepareFlags prepareFlags = prepareFlagsFromArguments(args);
+
+    /* If the prepared scene cache is enabled and up-to-date, memory-map it and
+       skip the importer altogether */
+    Containers::Optional<PreparedScene> scene;
+    if(args.isSet("cache")) {
+        TraceScope traceOpen{"load", "open cache"};
+        scene = PreparedScene::open(cacheFile, file, prepareFlags);
+    }
+    if(scene) {
+        Debug{} << "Using prepared scene" << cacheFile;
+        _timings.cached = true;
+    }
+
+    /* Otherwise import the file and prepare it in memory */
+    if(!scene) {
+        /* Load a scene importer plugin */
+        PluginManager::Manager<Trade::AbstractImporter> manager;
+        std::unique_ptr<Trade::AbstractImporter> importer = manager.loadAndInstantiate(args.value("importer"));
+        if(!importer) std::exit(1);
+
+        Debug{} << "Opening file" << file;
+
+        /* Record the files the scene is made from before importing them, so
+           a change done meanwhile makes the cache stale */
+        const std::vector<SourceFile> sources = sourceFiles(file);
+
+        /* Load file */
+        {
+            TraceScope traceOpen{"load", "open file"};
+            if(!importer->openFile(file))
+                std::exit(4);
+        }
+
+        /* Decode all images and meshes into CPU memory. This is the slowest
+           part of the import, so it's done on multiple threads, each having
+           its own importer instance. */
+        const UnsignedInt importThreadCount = resolveThreadCount(args.value<UnsignedInt>("import-threads"));
+        std::chrono::steady_clock::time_point importStart = std::chrono::steady_clock::now();
+        ImportedData data = importData(*importer, args.value("importer"), file, importThreadCount);
+        const std::chrono::duration<double, std::milli> importDuration = std::chrono::steady_clock::now() - importStart;
+        Debug{} << "Decoded images and meshes on" << importThreadCount << "threads in" << importDuration.count() << "ms";
+        _timings.importThreads = importThreadCount;
+        _timings.import = importDuration.count();
+
+        /* Optionally do the same once more on a single thread to see how much
+           the parallel import actually helps */
+        if(args.isSet("compare-serial")) {
+            importStart = std::chrono::steady_clock::now();
+            importData(*importer, args.value("importer"), file, 1);
+            const std::chrono::duration<double, std::milli> serialImportDuration = std::chrono::steady_clock::now() - importStart;
+            Debug{} << "Serial decoding took" << serialImportDuration.count() << "ms, speedup" << serialImportDuration.count()/importDuration.count() << Debug::nospace << "x";
+            _timings.serialImport = serialImportDuration.count();
+        }
+
+        /* Convert the data to a form that can be uploaded directly */
+        const std::chrono::steady_clock::time_point prepareStart = std::chrono::steady_clock::now();
+        scene = PreparedScene::prepare(data, sources, prepareFlags, importThreadCount);
+        _timings.prepare = std::chrono::duration<double, std::milli>{std::chrono::steady_clock::now() - prepareStart}.count();
+        if(args.isSet("cache")) {
+            TraceScope traceSave{"load", "save cache"};
+            if(scene->save(cacheFile))
+                Debug{} << "Saved prepared scene to" << cacheFile;
+        }
+    }
+
+    /* Upload all textures. Textures that fail to load will be NullOpt. */
+    const std::chrono::steady_clock::time_point uploadStart = std::chrono::steady_clock::now();
+    UnsignedLong uploadedSize = 0;
+    _textures = Containers::Array<Containers::Optional<GL::Texture2D>>{scene->textures().size()};
+    const std::vector<GL::CompressedPixelFormat> compressedFormats = supportedCompressedFormats();
+    for(UnsignedInt i = 0; i != scene->textures().size(); ++i) {
+        /* Warning about failed import was already printed */
+        const PreparedTexture& textureData = scene->textures()[i];
+        if(textureData.image == -1) continue;
+
+        TraceScope traceTexture{"upload", "upload texture", i};
+
+        const PreparedImage& imageData = scene->images()[textureData.image];
+        const bool compressed = imageData.flags & PreparedImage::Compressed;
+        GL::TextureFormat format;
+        if(imageData.levelCount && compressed) {
+            const GL::CompressedPixelFormat compressedFormat = GL::compressedPixelFormat(CompressedPixelFormat(imageData.format));
+            if(std::find(compressedFormats.begin(), compressedFormats.end(), compressedFormat) == compressedFormats.end()) {
+                Warning{} << "Compressed format" << compressedFormat << "is not supported by the GPU, skipping";
+                continue;
+            }
+            format = GL::TextureFormat(GLenum(compressedFormat));
+        } else if(imageData.levelCount && PixelFormat(imageData.format) == PixelFormat::RGB8Unorm)
+            format = GL::TextureFormat::RGB8;
+        else if(imageData.levelCount && PixelFormat(imageData.format) == PixelFormat::RGBA8Unorm)
+            format = GL::TextureFormat::RGBA8;
+        else {
+            Warning{} << "Cannot load texture image, skipping";
+            continue;
+        }
+
+        /* Configure the texture. Uncompressed images always have the whole
+           chain prepared, compressed ones only what was in the file. */
+        const Int levelCount = imageData.levelCount;
+        GL::Texture2D texture;
+        texture
+            .setMagnificationFilter(SamplerFilter(textureData.magnificationFilter))
+            .setMinificationFilter(SamplerFilter(textureData.minificationFilter), SamplerMipmap(textureData.mipmapFilter))
+            .setWrapping(Array2D<SamplerWrapping>{SamplerWrapping(textureData.wrapping[0]), SamplerWrapping(textureData.wrapping[1])})
+            .setStorage(levelCount, format, imageData.size);
+
+        /* GPUs usually pad RGB8 to four bytes per pixel, compressed formats
+           take exactly what the prepared levels take */
+        std::size_t textureSize = 0;
+        if(compressed) for(const PreparedLevel& level: scene->levels(imageData))
+            textureSize += level.dataSize;
+        else textureSize = MemoryTracker::textureSize({imageData.size, 1}, levelCount, 4);
+        _memory.set(texture, "texture " + std::to_string(i), textureSize);
+
+        /* Upload the tail of the mip chain and stream the rest later */
+        _textures[i] = std::move(texture);
+        _textureStreamer.add(*_textures[i], *scene, imageData);
+        for(const PreparedLevel& level: scene->levels(imageData))
+            uploadedSize += level.dataSize;
+    }
+
+    /* Count only what got actually uploaded so far */
+    uploadedSize -= _textureStreamer.pendingSize();
+
+    /* Upload all mesh buffers. Meshes that fail to load will be null. The
+       meshes themselves are set up later by instance batches that use them. */
+    _meshes = Containers::Array<std::unique_ptr<MeshBuffers>>{scene->meshes().size()};
+    for(UnsignedInt i = 0; i != scene->meshes().size(); ++i) {
+        /* Warning about failed import was already printed */
+        const PreparedMesh& meshData = scene->meshes()[i];
+        if(!meshData.count) continue;
+
+        TraceScope traceMesh{"upload", "upload mesh", i};
+        std::unique_ptr<MeshBuffers> mesh{new MeshBuffers{meshData}};
+        mesh->vertices.setData(scene->vertexData(meshData), GL::BufferUsage::StaticDraw);
+        if(meshData.indexSize)
+            mesh->indices.setData(scene->indexData(meshData), GL::BufferUsage::StaticDraw);
+        uploadedSize += meshData.vertexDataSize + meshData.indexDataSize;
+        _memory.set(mesh->vertices, "mesh " + std::to_string(i) + " vertices", meshData.vertexDataSize);
+        if(meshData.indexSize)
+            _memory.set(mesh->indices, "mesh " + std::to_string(i) + " indices", meshData.indexDataSize);
+
+        _meshes[i] = std::move(mesh);
+    }
+
+    const std::chrono::steady_clock::time_point uploadEnd = std::chrono::steady_clock::now();
+    const std::chrono::duration<double, std::milli> uploadDuration = uploadEnd - uploadStart;
+    Debug{} << "Uploaded textures and meshes in" << uploadDuration.count() << "ms";
+    _timings.upload = uploadDuration.count();
+    Tracer::global().add("load", "upload", uploadStart, uploadEnd);
+    if(const std::size_t pendingSize = _textureStreamer.pendingSize())
+        Debug{} << "Streaming" << pendingSize/1024 << "kB of texture data in" << _textureStreamer.pendingLevelCount() << "levels," << _textureStreamer.budget()/1024 << "kB per frame";
+
+    /* Estimate what the deduplication saved, assuming the upload time is
+       proportional to the data size */
+    const PreparedHeader& header = scene->header();
+    if(const UnsignedLong savedSize = header.duplicateTextureSize + header.duplicateMeshSize) {
+        Debug{} << "Sharing" << header.duplicateTextureCount << "duplicate textures and"
+            << header.duplicateMeshCount << "duplicate meshes saved"
+            << savedSize/1024 << "kB of GPU memory and about"
+            << (uploadedSize ? uploadDuration.count()*savedSize/uploadedSize : 0.0) << "ms of upload";
+    }
+
+    /* Add all objects into a flat transformation hierarchy, with the
+       manipulator as the root. The prepared scene has parents always before
+       their children, so the parent node is always added already. */
+    const std::chrono::steady_clock::time_point populateStart = std::chrono::steady_clock::now();
+    _hierarchy.add(-1, Matrix4{});
+    for(const PreparedObject& objectData: scene->objects())
+        addObject(*scene, objectData);
+    Debug{} << scene->objects().size() << "objects drawn in" << _batches.size() << "instanced batches";
+
+    /* Build a BVH over all drawable objects for frustum culling */
+    std::vector<Range3D> bounds(_drawableObjects.size());
+    for(std::size_t i = 0; i != bounds.size(); ++i)
+        bounds[i] = _drawableObjects[i].bounds;
+    _bvh.build(bounds);
+    Debug{} << "Built a BVH with" << _bvh.nodeCount() << "nodes over" << _bvh.itemCount() << "drawable objects";
+
+    /* Pick occluders while the mesh data are still around */
+    if(const std::size_t maxOccluderCount = args.value<std::size_t>("occluders"))
+        addOccluders(*scene, maxOccluderCount);
+    const std::chrono::steady_clock::time_point populateEnd = std::chrono::steady_clock::now();
+    _timings.populate = std::chrono::duration<double, std::milli>{populateEnd - populateStart}.count();
+    Tracer::global().add("load", "populate", populateStart, populateEnd);
+
+    /* Frame uniforms get respecified every frame, but always with the same
+       size */
+    _memory.set(_frameUniforms, "frame uniforms", sizeof(InstancedPhongShader::FrameUniforms));
+
+    /* The queued texture levels reference the prepared scene data, keep it
+       alive until they're all uploaded */
+    if(_textureStreamer.pendingLevelCount())
+        _memory.set(MemoryTracker::Type::CpuData, std::uintptr_t(&_textureStreamer), "prepared scene", scene->size());
+    _textureStreamer.setScene(std::move(*scene));
+
+    const std::chrono::steady_clock::time_point startupEnd = std::chrono::steady_clock::now();
+    const std::chrono::duration<double, std::milli> startupDuration = startupEnd - startupStart;
+    Debug{} << "Scene ready in" << startupDuration.count() << "ms";
+    _timings.total = startupDuration.count();
+
+    /* Uploads are only queued on the GL side, so the trace shows the CPU
+       time and not when the GPU actually gets the data */
+    if(!traceFile.empty()) {
+        Tracer& tracer = Tracer::global();
+        tracer.add("load", "load", startupStart, startupEnd);
+        if(Utility::Directory::writeString(traceFile, tracer.json()))
+            Debug{} << "Saved" << tracer.eventCount() << "trace events to" << traceFile;
+        tracer.setEnabled(false);
+    }
+}
+
+void ViewerScene::addObject(const PreparedScene& scene, const PreparedObject& objectData) {
+    /* Add the object to the hierarchy. Node 0 is the manipulator and object
+       nodes follow in the same order, so the parent index is just shifted by
+       one, which conveniently maps -1 to the manipulator. */
+    const UnsignedInt node = _hierarchy.add(objectData.parent + 1, objectData.transformation);
+
+    /* Add a drawable if the object has a mesh and the mesh is loaded */
+    if(objectData.mesh == -1 || !_meshes[objectData.mesh]) return;
+
+    InstanceBatch* instanceBatch;
+    Color4 color{1.0f};
+
+    /* Material not available / not loaded, use a default material */
+    if(objectData.material == -1) {
+        instanceBatch = &batch(objectData.mesh, -1);
+
+    /* Textured material. If the texture failed to load, use the fallback
+       color, which is white. */
+    } else {
+        const PreparedMaterial& material = scene.materials()[objectData.material];
+        if(material.diffuseTexture != -1 && _textures[material.diffuseTexture])
+            instanceBatch = &batch(objectData.mesh, material.diffuseTexture);
+        else {
+            instanceBatch = &batch(objectData.mesh, -1);
+            color = material.diffuseColor;
+        }
+    }
+
+    /* Only the new node is dirty, so this calculates just its world
+       transformation. The manipulator has an identity transformation at this
+       point, so the world transformation is relative to the manipulator. */
+    _hierarchy.update();
+    _drawableObjects.push_back({node, instanceBatch, color,
+        transformBounds(_hierarchy.worldTransformation(node), scene.meshes()[objectData.mesh].bounds)});
+}
+
+void ViewerScene::addOccluders(const PreparedScene& scene, const std::size_t maxCount) {
+    TraceScope traceOccluders{"load", "pick occluders"};
+
+    /* Objects designated as occluders if there are any, otherwise the ones
+       with the largest bounds, which in interiors are the walls and floors.
+       Object nodes are shifted by one from object indices. */
+    std::vector<UnsignedInt> candidates;
+    for(std::size_t i = 0; i != _drawableObjects.size(); ++i)
+        if(scene.objects()[_drawableObjects[i].node - 1].flags & PreparedObject::Occluder)
+            candidates.push_back(i);
+    const bool designated = !candidates.empty();
+    if(!designated) {
+        candidates.resize(_drawableObjects.size());
+        std::iota(candidates.begin(), candidates.end(), 0);
+        std::sort(candidates.begin(), candidates.end(), [this](UnsignedInt a, UnsignedInt b) {
+            return _drawableObjects[a].bounds.size().dot() > _drawableObjects[b].bounds.size().dot();
+        });
+    }
+
+    std::size_t triangleCount = 0;
+    for(const UnsignedInt i: candidates) {
+        if(!designated && _occluders.size() == maxCount) break;
+
+        const DrawableObject& object = _drawableObjects[i];
+        const PreparedMesh& mesh = scene.meshes()[scene.objects()[object.node - 1].mesh];
+        if(MeshPrimitive(mesh.primitive) != MeshPrimitive::Triangles ||
+           mesh.lods[0].count/3 > MaxOccluderTriangles)
+            continue;
+
+        std::vector<Vector3> triangles = occluderTriangles(scene, mesh);
+        if(triangles.empty()) continue;
+        triangleCount += triangles.size()/3;
+        _occluders.push_back({object.node, std::move(triangles)});
+    }
+
+    if(_occluders.empty()) return;
+    Debug{} << "Using" << _occluders.size() << (designated ? "designated" : "largest") << "objects with" << triangleCount << "triangles as occluders";
+    _memory.set(MemoryTracker::Type::CpuData, std::uintptr_t(&_occlusionBuffer), "occlusion culling", _occlusionBuffer.dataSize() + triangleCount*3*sizeof(Vector3));
+}
+
+InstanceBatch& ViewerScene::batch(const Int mesh, const Int texture) {
+    /* Colored objects with the same mesh all go to the same batch, textured
+       ones additionally need to share the texture. The sort key identifies
+       the batch uniquely, so it's used for the lookup as well. */
+    const UnsignedLong sortKey = RenderQueue::sortKey(texture == -1 ? 0 : 1, texture, mesh);
+    InstanceBatch*& found = _batchLookup[sortKey];
+    if(!found) {
+        _batches.emplace_back(texture == -1 ?
+            new InstanceBatch{_coloredShader, *_meshes[mesh], nullptr, sortKey} :
+            new InstanceBatch{_texturedShader, *_meshes[mesh], &*_textures[texture], sortKey});
+        found = _batches.back().get();
+    }
+
+    return *found;
+}
+
+void ViewerScene::draw() {
+    /* Stream the next few texture levels. The uploads go through pixel
+       buffers, so this doesn't wait for the GPU. */
+    _streamedTextureSize = _textureStreamer.update();
+    if(_streamedTextureSize && !_textureStreamer.pendingLevelCount())
+        _memory.remove(MemoryTracker::Type::CpuData, std::uintptr_t(&_textureStreamer));
+
+    /* The manipulator is the hierarchy root. Rotating it makes all world
+       transformations recalculated in a single linear pass, otherwise the
+       scene is static and the update does nothing. */
+    if(_hierarchy.transformation(0) != _manipulator.transformationMatrix())
+        _hierarchy.setTransformation(0, _manipulator.transformationMatrix());
+    _updatedTransformations = _hierarchy.update();
+
+    /* The objects only add their transformations into instance batches in
+       the render queue, which then draws each batch with a single draw call,
+       sorted to minimize state changes. Objects never move relative to the
+       manipulator, so instead of updating the BVH when the manipulator
+       rotates, the frustum is transformed into the manipulator space. */
+    const Matrix4 cameraMatrix = _camera->cameraMatrix();
+    _renderQueue.setLodScale(_lod && _lodError > 0.0f ?
+        _camera->projectionMatrix()[1][1]*_camera->viewport().y()*0.5f/_lodError : 0.0f);
+    _occludedObjects = 0;
+    if(_culling) {
+        const Matrix4 projectionMatrix = _camera->projectionMatrix()*cameraMatrix;
+        const Matrix4 manipulatorProjectionMatrix = projectionMatrix*_manipulator.transformationMatrix();
+        _testedNodes = _bvh.cull(frustumPlanes(manipulatorProjectionMatrix), _visibleObjects);
+
+        /* Rasterize the occluders into the software depth buffer and drop
+           objects that are completely behind them. Occluders are never
+           culled by themselves, as their closest point is never behind their
+           own surface. */
+        if(_occlusionCulling && !_occluders.empty()) {
+            _occlusionBuffer.clear();
+            _occluderTriangles = 0;
+            for(const Occluder& occluder: _occluders)
+                _occluderTriangles += _occlusionBuffer.rasterize(projectionMatrix*_hierarchy.worldTransformation(occluder.node), occluder.triangles);
+            _occlusionBuffer.buildPyramid();
+
+            std::size_t visible = 0;
+            for(std::size_t i = 0; i != _visibleObjects.size(); ++i)
+                if(_occlusionBuffer.isVisible(manipulatorProjectionMatrix, _drawableObjects[_visibleObjects[i]].bounds))
+                    _visibleObjects[visible++] = _visibleObjects[i];
+            _occludedObjects = _visibleObjects.size() - visible;
+            _visibleObjects.resize(visible);
+        }
+
+        for(const UnsignedInt i: _visibleObjects) {
+            const DrawableObject& object = _drawableObjects[i];
+            _renderQueue.add(*object.batch, cameraMatrix*_hierarchy.worldTransformation(object.node), object.color);
+        }
+    } else for(const DrawableObject& object: _drawableObjects)
+        _renderQueue.add(*object.batch, cameraMatrix*_hierarchy.worldTransformation(object.node), object.color);
+
+    /* Camera and light data are the same for all batches and both shaders,
+       so they're uploaded to a uniform buffer just once per frame */
+    const InstancedPhongShader::FrameUniforms frameUniforms{
+        _camera->projectionMatrix(),
+        Vector4{cameraMatrix.transformPoint({-3.0f, 10.0f, 10.0f}), 1.0f}};
+    _frameUniforms.setData(Containers::arrayView(&frameUniforms, 1), GL::BufferUsage::StreamDraw);
+    InstancedPhongShader::bindFrameUniforms(_frameUniforms);
+    _renderQueue.submit();
+}
+
+void ViewerScene::printStatistics() const {
+    const RenderQueue::Statistics& stats = _renderQueue.statistics();
+    if(_culling)
+        Debug{} << _visibleObjects.size() << "of" << _drawableObjects.size() << "objects visible," << _testedNodes << "of" << _bvh.nodeCount() << "BVH nodes tested";
+    if(_culling && _occlusionCulling && !_occluders.empty())
+        Debug{} << _occludedObjects << "objects culled by" << _occluders.size() << "occluders with" << _occluderTriangles << "triangles rasterized";
+    Debug{} << _updatedTransformations << "of" << _hierarchy.size() << "world transformations updated";
+    Debug{} << stats.drawables << "drawables in" << stats.drawCalls << "draw calls";
+    Debug{} << stats.triangles << "triangles, full detail would be" << stats.fullDetailTriangles;
+    if(_streamedTextureSize)
+        Debug{} << "Streamed" << _streamedTextureSize/1024 << "kB of texture data," << _textureStreamer.pendingSize()/1024 << "kB remaining";
+    Debug{} << "State changes: program" << stats.programChanges << "(unsorted" << stats.unsortedProgramChanges << Debug::nospace << "), texture" << stats.textureChanges << "(unsorted" << stats.unsortedTextureChanges << Debug::nospace << "), mesh" << stats.meshChanges << "(unsorted" << stats.unsortedMeshChanges << Debug::nospace << ")";
+    Debug{} << "Saved" << (stats.unsortedProgramChanges + stats.unsortedTextureChanges + stats.unsortedMeshChanges) - (stats.programChanges + stats.textureChanges + stats.meshChanges) << "state changes";
+}
+
+const MemoryTracker& ViewerScene::memory() {
+    for(std::size_t i = 0; i != _batches.size(); ++i)
+        _batches[i]->trackMemory(_memory, "batch " + std::to_string(i));
+    return _memory;
+}
+
+}}
@@ -0,0 +1,238 @@
+#ifndef Magnum_Examples_ViewerScene_h
+#define Magnum_Examples_ViewerScene_h
+/*
+    This file is part of Magnum.
+
+    Original authors — credit is appreciated but not required:
+
+        2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018 —
+            Vladimír Vondruš <mosra@centrum.cz>
+
+    This is free and unencumbered software released into the public domain.
+
+    Anyone is free to copy, modify, publish, use, compile, sell, or distribute
+    this software, either in source code form or as a compiled binary, for any
+    purpose, commercial or non-commercial, and by any means.
+
+    In jurisdictions that recognize copyright laws, the author or authors of
+    this software dedicate any and all copyright interest in the software to
+    the public domain. We make this dedication for the benefit of the public
+    at large and to the detriment of our heirs and successors. We intend this
+    dedication to be an overt act of relinquishment in perpetuity of all
+    present and future rights to this software under copyright law.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Utility/Utility.h>
+#include <Magnum/GL/Texture.h>
+#include <Magnum/SceneGraph/MatrixTransformation3D.h>
+#include <Magnum/SceneGraph/Scene.h>
+#include <Magnum/SceneGraph/SceneGraph.h>
+
+#include "Bvh.h"
+#include "InstancedDrawable.h"
+#include "MemoryTracker.h"
+#include "OcclusionBuffer.h"
+#include "RenderQueue.h"
+#include "TextureStreamer.h"
+#include "TransformHierarchy.h"
+
+namespace Magnum { namespace Examples {
+
+typedef SceneGraph::Object<SceneGraph::MatrixTransformation3D> Object3D;
+typedef SceneGraph::Scene<SceneGraph::MatrixTransformation3D> Scene3D;
+
+/**
+@brief Viewer scene
+
+Loads a scene file, uploads it to the GPU and draws it. Shared between the
+interactive viewer and the windowless benchmark, which only differ in how the
+camera and the scene are moved around.
+*/
+class ViewerScene {
+    public:
+        /** @brief Durations of the loading phases in milliseconds */
+        struct Timings {
+            bool cached;                /**< Prepared scene cache was used */
+            UnsignedInt importThreads;  /**< Threads used for the import */
+            Double import;              /**< Decoding images and meshes */
+            Double serialImport;        /**< The same on a single thread */
+            Double prepare;             /**< Converting to a prepared scene */
+            Double upload;              /**< Uploading textures and meshes */
+            Double populate;            /**< Creating objects and the BVH */
+            Double total;               /**< Everything together */
+        };
+
+        /** @brief Add command-line arguments used by the constructor */
+        static void addArguments(Utility::Arguments& args);
+
+        /**
+         * @brief Constructor
+         *
+         * Expects that @p args were set up with @ref addArguments() and
+         * parsed. Exits the application if the file can't be opened.
+         */
+        explicit ViewerScene(const Utility::Arguments& args, const Vector2i& viewportSize);
+
+        /** @brief Parent of all scene objects */
+        Object3D& manipulator() { return _manipulator; }
+
+        /** @brief Object holding the camera */
+        Object3D& cameraObject() { return _cameraObject; }
+
+        SceneGraph::Camera3D& camera() { return *_camera; }
+
+        const Timings& timings() const { return _timings; }
+
+        /** @brief Whether frustum culling is enabled */
+        bool isCullingEnabled() const { return _culling; }
+
+        /** @brief Enable or disable frustum culling */
+        void setCullingEnabled(bool enabled) { _culling = enabled; }
+
+        /** @brief Whether occlusion culling is enabled */
+        bool isOcclusionCullingEnabled() const { return _occlusionCulling; }
+
+        /**
+         * @brief Enable or disable occlusion culling
+         *
+         * Objects that passed frustum culling are tested against a software
+         * depth buffer with a few large occluders. Has an effect only if
+         * frustum culling is enabled and the scene has some occluders.
+         */
+        void setOcclusionCullingEnabled(bool enabled) { _occlusionCulling = enabled; }
+
+        /** @brief Count of occluders */
+        std::size_t occluderCount() const { return _occluders.size(); }
+
+        /**
+         * @brief Count of objects culled by occlusion in the last frame
+         *
+         * These aren't included in @ref visibleObjectCount().
+         */
+        std::size_t occludedObjectCount() const { return _occludedObjects; }
+
+        /** @brief Whether level of detail selection is enabled */
+        bool isLodEnabled() const { return _lod; }
+
+        /**
+         * @brief Enable or disable level of detail selection
+         *
+         * If disabled, all meshes are drawn in full detail.
+         */
+        void setLodEnabled(bool enabled) { _lod = enabled; }
+
+        /** @brief Count of drawable objects */
+        std::size_t objectCount() const { return _drawableObjects.size(); }
+
+        /**
+         * @brief Count of objects visible in the last frame
+         *
+         * If culling is disabled, returns @ref objectCount().
+         */
+        std::size_t visibleObjectCount() const {
+            return _culling ? _visibleObjects.size() : _drawableObjects.size();
+        }
+
+        /**
+         * @brief Texture data waiting for upload in bytes
+         *
+         * Textures are streamed progressively from the smallest mip levels,
+         * a part of the budget is uploaded with each @ref draw().
+         */
+        std::size_t pendingTextureSize() const {
+            return _textureStreamer.pendingSize();
+        }
+
+        /** @brief Render statistics of the last frame */
+        const RenderQueue::Statistics& renderStatistics() const {
+            return _renderQueue.statistics();
+        }
+
+        /**
+         * @brief Draw the scene
+         *
+         * Expects that the framebuffer is bound and cleared.
+         */
+        void draw();
+
+        /** @brief Print statistics of the last frame */
+        void printStatistics() const;
+
+        /**
+         * @brief Memory used by GPU resources and the prepared scene
+         *
+         * Instance buffers are resized on every @ref draw(), so their sizes
+         * are updated on every call.
+         */
+        const MemoryTracker& memory();
+
+    private:
+        void addObject(const PreparedScene& scene, const PreparedObject& objectData);
+        void addOccluders(const PreparedScene& scene, std::size_t maxCount);
+        InstanceBatch& batch(Int mesh, Int texture);
+
+        InstancedPhongShader _coloredShader,
+            _texturedShader{InstancedPhongShader::Flag::DiffuseTexture};
+        Containers::Array<std::unique_ptr<MeshBuffers>> _meshes;
+        Containers::Array<Containers::Optional<GL::Texture2D>> _textures;
+        TextureStreamer _textureStreamer;
+        std::size_t _streamedTextureSize{};
+        std::vector<std::unique_ptr<InstanceBatch>> _batches;
+        std::unordered_map<UnsignedLong, InstanceBatch*> _batchLookup;
+        RenderQueue _renderQueue;
+        GL::Buffer _frameUniforms{GL::Buffer::TargetHint::Uniform};
+        MemoryTracker _memory;
+
+        /* Objects in a flat hierarchy with the manipulator as the root.
+           Drawable objects have their hierarchy node, batch, color and bounds
+           relative to the manipulator, indexed by the BVH. */
+        struct DrawableObject {
+            UnsignedInt node;
+            InstanceBatch* batch;
+            Color4 color;
+            Range3D bounds;
+        };
+        TransformHierarchy _hierarchy;
+        std::size_t _updatedTransformations{};
+        std::vector<DrawableObject> _drawableObjects;
+        Bvh _bvh;
+        std::vector<UnsignedInt> _visibleObjects;
+        std::size_t _testedNodes{};
+        bool _culling{true};
+
+        /* Occluders have their hierarchy node and triangles of the
+           full-detail level in object space, three vertices each */
+        struct Occluder {
+            UnsignedInt node;
+            std::vector<Vector3> triangles;
+        };
+        std::vector<Occluder> _occluders;
+        OcclusionBuffer _occlusionBuffer{{256, 128}};
+        std::size_t _occludedObjects{}, _occluderTriangles{};
+        bool _occlusionCulling{true};
+
+        bool _lod{true};
+        Float _lodError;
+
+        Timings _timings;
+
+        Scene3D _scene;
+        Object3D _manipulator, _cameraObject;
+        SceneGraph::Camera3D* _camera;
+};
+
+}}
+
+#endif